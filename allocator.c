@@ -0,0 +1,526 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "allocator.h"
+
+#include "lvgl/lvgl.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Static variables
+ */
+
+static allocator_phase_t phase = ALLOCATOR_PHASE_STARTUP;
+
+#if USE_ALLOCATOR_WRAP
+/* Calls to the heap functions from the program's own objects, these happen on any thread */
+static atomic_uint heap_allocations[ALLOCATOR_NUM_PHASES];
+static atomic_uint heap_frees[ALLOCATOR_NUM_PHASES];
+
+/* The originals behind the linker wrappers. The custom allocator uses them directly so that its
+ * blocks are counted as LVGL allocations only. */
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+#define heap_malloc __real_malloc
+#define heap_realloc __real_realloc
+#define heap_free __real_free
+#else
+#define heap_malloc malloc
+#define heap_realloc realloc
+#define heap_free free
+#endif /* USE_ALLOCATOR_WRAP */
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Copy the heap call counts into the statistics.
+ *
+ * @param out statistics to complete
+ */
+static void get_heap_stats(allocator_stats *out);
+
+
+/**
+ * Static functions
+ */
+
+static void get_heap_stats(allocator_stats *out) {
+#if USE_ALLOCATOR_WRAP
+    for (int i = 0; i < ALLOCATOR_NUM_PHASES; ++i) {
+        out->heap_allocations[i] = atomic_load_explicit(&(heap_allocations[i]), memory_order_relaxed);
+        out->heap_frees[i] = atomic_load_explicit(&(heap_frees[i]), memory_order_relaxed);
+    }
+#else
+    LV_UNUSED(out);
+#endif /* USE_ALLOCATOR_WRAP */
+}
+
+
+/**
+ * Heap wrappers, installed with the linker's --wrap option (see meson.build)
+ */
+
+#if USE_ALLOCATOR_WRAP
+void *__wrap_malloc(size_t size) {
+    atomic_fetch_add_explicit(&(heap_allocations[phase]), 1, memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t num, size_t size) {
+    atomic_fetch_add_explicit(&(heap_allocations[phase]), 1, memory_order_relaxed);
+    return __real_calloc(num, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    atomic_fetch_add_explicit(&(heap_allocations[phase]), 1, memory_order_relaxed);
+    if (ptr) {
+        atomic_fetch_add_explicit(&(heap_frees[phase]), 1, memory_order_relaxed);
+    }
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr) {
+    if (ptr) {
+        atomic_fetch_add_explicit(&(heap_frees[phase]), 1, memory_order_relaxed);
+    }
+    __real_free(ptr);
+}
+#endif /* USE_ALLOCATOR_WRAP */
+
+#if LV_MEM_CUSTOM
+
+/**
+ * Static variables
+ */
+
+#ifndef ALLOCATOR_ARENA_SIZE
+#define ALLOCATOR_ARENA_SIZE (LV_MEM_SIZE_KB * 1024U)
+#endif
+
+#define ALLOCATOR_ALIGN 16U
+#define ALLOCATOR_ALIGN_UP(n) (((n) + ALLOCATOR_ALIGN - 1) & ~((size_t)ALLOCATOR_ALIGN - 1))
+
+/* Where a block lives */
+typedef enum {
+    ALLOCATOR_BLOCK_HEAP = 0,
+    ALLOCATOR_BLOCK_ARENA = 1,
+    ALLOCATOR_BLOCK_POOL = 2
+} allocator_block_kind_t;
+
+/* Header preceding every block, padded to keep the payload aligned */
+typedef union {
+    struct {
+        size_t size;
+        uint32_t kind;
+        uint32_t size_class;
+    } info;
+    unsigned char padding[ALLOCATOR_ALIGN];
+} allocator_header;
+
+static allocator_stats stats = { 0 };
+
+#if USE_ALLOCATOR_ARENA
+/* Bump arena for init-time allocations, frozen after the first frame */
+static _Alignas(ALLOCATOR_ALIGN) unsigned char arena[ALLOCATOR_ARENA_SIZE];
+static size_t arena_used = 0;
+static size_t arena_dead = 0;
+static bool is_arena_frozen = false;
+#endif /* USE_ALLOCATOR_ARENA */
+
+#if USE_ALLOCATOR_POOL
+#define ALLOCATOR_POOL_NUM_CLASSES 5
+#define ALLOCATOR_POOL_SLAB_SIZE (4U * 1024U)
+
+/* Free list node stored in unused pool blocks */
+typedef struct allocator_pool_node {
+    struct allocator_pool_node *next;
+} allocator_pool_node;
+
+/* Payload sizes of the pool size classes */
+static const size_t pool_class_sizes[ALLOCATOR_POOL_NUM_CLASSES] = { 16, 32, 64, 128, 256 };
+static allocator_pool_node *pool_free_lists[ALLOCATOR_POOL_NUM_CLASSES] = { NULL };
+static size_t pool_total_bytes = 0;
+static size_t pool_free_bytes = 0;
+#endif /* USE_ALLOCATOR_POOL */
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Allocate a block including its header.
+ *
+ * @param size payload size in bytes
+ * @return pointer to the block header or NULL on failure
+ */
+static allocator_header *alloc_block(size_t size);
+
+/**
+ * Release a block including its header.
+ *
+ * @param header pointer to the block header
+ */
+static void free_block(allocator_header *header);
+
+/**
+ * Account for a new allocation in the statistics.
+ *
+ * @param size payload size in bytes
+ */
+static void track_alloc(size_t size);
+
+/**
+ * Account for a freed allocation in the statistics.
+ *
+ * @param size payload size in bytes
+ */
+static void track_free(size_t size);
+
+#if USE_ALLOCATOR_POOL
+/**
+ * Find the smallest pool size class fitting a payload.
+ *
+ * @param size payload size in bytes
+ * @return index of the size class or -1 if the payload is too large for the pools
+ */
+static int find_pool_class(size_t size);
+
+/**
+ * Carve a new slab into blocks of a size class and add them to its free list.
+ *
+ * @param size_class index of the size class
+ * @return true on success, false otherwise
+ */
+static bool grow_pool(int size_class);
+#endif /* USE_ALLOCATOR_POOL */
+
+
+/**
+ * Static functions
+ */
+
+static allocator_header *alloc_block(size_t size) {
+    allocator_header *header = NULL;
+
+#if USE_ALLOCATOR_ARENA
+    size_t block_size = sizeof(allocator_header) + ALLOCATOR_ALIGN_UP(size);
+    if (!is_arena_frozen && arena_used + block_size <= ALLOCATOR_ARENA_SIZE) {
+        header = (allocator_header *)&(arena[arena_used]);
+        header->info.kind = ALLOCATOR_BLOCK_ARENA;
+        arena_used += block_size;
+    }
+#endif /* USE_ALLOCATOR_ARENA */
+
+#if USE_ALLOCATOR_POOL
+    int size_class = find_pool_class(size);
+    if (!header && size_class >= 0 && (pool_free_lists[size_class] || grow_pool(size_class))) {
+        allocator_pool_node *node = pool_free_lists[size_class];
+        pool_free_lists[size_class] = node->next;
+        pool_free_bytes -= sizeof(allocator_header) + pool_class_sizes[size_class];
+        header = (allocator_header *)node;
+        header->info.kind = ALLOCATOR_BLOCK_POOL;
+        header->info.size_class = size_class;
+    }
+#endif /* USE_ALLOCATOR_POOL */
+
+    if (!header) {
+        header = heap_malloc(sizeof(allocator_header) + size);
+        if (!header) {
+            return NULL;
+        }
+        header->info.kind = ALLOCATOR_BLOCK_HEAP;
+    }
+
+    header->info.size = size;
+    return header;
+}
+
+static void free_block(allocator_header *header) {
+    switch (header->info.kind) {
+#if USE_ALLOCATOR_ARENA
+    case ALLOCATOR_BLOCK_ARENA: {
+        size_t block_size = sizeof(allocator_header) + ALLOCATOR_ALIGN_UP(header->info.size);
+        if ((unsigned char *)header + block_size == &(arena[arena_used]) && !is_arena_frozen) {
+            arena_used -= block_size; /* Most recent block, roll back the bump pointer */
+        } else {
+            arena_dead += block_size;
+        }
+        break;
+    }
+#endif /* USE_ALLOCATOR_ARENA */
+#if USE_ALLOCATOR_POOL
+    case ALLOCATOR_BLOCK_POOL: {
+        int size_class = header->info.size_class;
+        allocator_pool_node *node = (allocator_pool_node *)header;
+        node->next = pool_free_lists[size_class];
+        pool_free_lists[size_class] = node;
+        pool_free_bytes += sizeof(allocator_header) + pool_class_sizes[size_class];
+        break;
+    }
+#endif /* USE_ALLOCATOR_POOL */
+    default:
+        heap_free(header);
+        break;
+    }
+}
+
+static void track_alloc(size_t size) {
+    stats.live_bytes += size;
+    stats.live_allocations++;
+    stats.allocations[phase]++;
+    if (stats.live_bytes > stats.peak_bytes) {
+        stats.peak_bytes = stats.live_bytes;
+    }
+}
+
+static void track_free(size_t size) {
+    stats.live_bytes -= size;
+    stats.live_allocations--;
+    stats.frees[phase]++;
+}
+
+#if USE_ALLOCATOR_POOL
+static int find_pool_class(size_t size) {
+    for (int i = 0; i < ALLOCATOR_POOL_NUM_CLASSES; ++i) {
+        if (size <= pool_class_sizes[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool grow_pool(int size_class) {
+    unsigned char *slab = heap_malloc(ALLOCATOR_POOL_SLAB_SIZE);
+    if (!slab) {
+        return false;
+    }
+
+    size_t block_size = sizeof(allocator_header) + pool_class_sizes[size_class];
+    size_t num_blocks = ALLOCATOR_POOL_SLAB_SIZE / block_size;
+    for (size_t i = 0; i < num_blocks; ++i) {
+        allocator_pool_node *node = (allocator_pool_node *)(slab + i * block_size);
+        node->next = pool_free_lists[size_class];
+        pool_free_lists[size_class] = node;
+    }
+
+    pool_total_bytes += num_blocks * block_size;
+    pool_free_bytes += num_blocks * block_size;
+    return true;
+}
+#endif /* USE_ALLOCATOR_POOL */
+
+
+/**
+ * Public functions
+ */
+
+void *allocator_alloc(size_t size) {
+    allocator_header *header = alloc_block(size);
+    if (!header) {
+        printf("Could not allocate %zu bytes\n", size);
+        return NULL;
+    }
+
+    track_alloc(size);
+    return header + 1;
+}
+
+void allocator_free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    allocator_header *header = (allocator_header *)ptr - 1;
+    track_free(header->info.size);
+    free_block(header);
+}
+
+void *allocator_realloc(void *ptr, size_t size) {
+    if (!ptr) {
+        return allocator_alloc(size);
+    }
+
+    allocator_header *header = (allocator_header *)ptr - 1;
+    size_t old_size = header->info.size;
+
+    if (header->info.kind == ALLOCATOR_BLOCK_HEAP) {
+        allocator_header *new_header = heap_realloc(header, sizeof(allocator_header) + size);
+        if (!new_header) {
+            printf("Could not reallocate %zu bytes\n", size);
+            return NULL;
+        }
+        new_header->info.size = size;
+        stats.live_bytes = stats.live_bytes - old_size + size;
+        if (stats.live_bytes > stats.peak_bytes) {
+            stats.peak_bytes = stats.live_bytes;
+        }
+        stats.allocations[phase]++;
+        stats.frees[phase]++;
+        return new_header + 1;
+    }
+
+    void *new_ptr = allocator_alloc(size);
+    if (!new_ptr) {
+        return NULL;
+    }
+
+    memcpy(new_ptr, ptr, LV_MIN(old_size, size));
+    allocator_free(ptr);
+    return new_ptr;
+}
+
+void allocator_end_startup(void) {
+    if (phase == ALLOCATOR_PHASE_STEADY) {
+        return;
+    }
+
+#if USE_ALLOCATOR_ARENA
+    is_arena_frozen = true;
+#endif /* USE_ALLOCATOR_ARENA */
+
+    allocator_log_stats("startup");
+    phase = ALLOCATOR_PHASE_STEADY;
+}
+
+void allocator_get_stats(allocator_stats *out) {
+    *out = stats;
+    get_heap_stats(out);
+
+#if USE_ALLOCATOR_ARENA
+    out->name = "arena";
+    out->frag_pct = arena_used > 0 ? (uint8_t)(arena_dead * 100 / arena_used) : 0;
+#elif USE_ALLOCATOR_POOL
+    out->name = "pool";
+    out->frag_pct = pool_total_bytes > 0 ? (uint8_t)(pool_free_bytes * 100 / pool_total_bytes) : 0;
+#else
+    out->name = "malloc";
+    out->frag_pct = 0;
+#endif
+}
+
+#else /* LV_MEM_CUSTOM */
+
+#if USE_ALLOCATOR_WRAP
+/**
+ * Static variables
+ */
+
+/* Calls from outside of lv_mem.c, LVGL only runs on the main thread */
+static uint32_t lv_mem_allocations[ALLOCATOR_NUM_PHASES];
+static uint32_t lv_mem_frees[ALLOCATOR_NUM_PHASES];
+
+/* The built-in allocator behind the linker wrappers */
+void *__real_lv_mem_alloc(size_t size);
+void __real_lv_mem_free(void *data);
+void *__real_lv_mem_realloc(void *data_p, size_t new_size);
+
+
+/**
+ * LVGL allocator wrappers, installed with the linker's --wrap option (see meson.build)
+ */
+
+void *__wrap_lv_mem_alloc(size_t size) {
+    lv_mem_allocations[phase]++;
+    return __real_lv_mem_alloc(size);
+}
+
+void __wrap_lv_mem_free(void *data) {
+    if (data) {
+        lv_mem_frees[phase]++;
+    }
+    __real_lv_mem_free(data);
+}
+
+void *__wrap_lv_mem_realloc(void *data_p, size_t new_size) {
+    lv_mem_allocations[phase]++;
+    if (data_p) {
+        lv_mem_frees[phase]++;
+    }
+    return __real_lv_mem_realloc(data_p, new_size);
+}
+#endif /* USE_ALLOCATOR_WRAP */
+
+
+/**
+ * Public functions
+ */
+
+void allocator_end_startup(void) {
+    if (phase == ALLOCATOR_PHASE_STEADY) {
+        return;
+    }
+
+    allocator_log_stats("startup");
+    phase = ALLOCATOR_PHASE_STEADY;
+}
+
+void allocator_get_stats(allocator_stats *out) {
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+
+    memset(out, 0, sizeof(*out));
+    out->name = "builtin";
+    out->live_bytes = mon.total_size - mon.free_size;
+    out->peak_bytes = mon.max_used;
+    out->live_allocations = mon.used_cnt;
+    out->frag_pct = mon.frag_pct;
+#if USE_ALLOCATOR_WRAP
+    memcpy(out->allocations, lv_mem_allocations, sizeof(out->allocations));
+    memcpy(out->frees, lv_mem_frees, sizeof(out->frees));
+#endif /* USE_ALLOCATOR_WRAP */
+    get_heap_stats(out);
+}
+
+#endif /* LV_MEM_CUSTOM */
+
+void allocator_log_stats(const char *context) {
+    allocator_stats current;
+    allocator_get_stats(&current);
+
+#if LV_MEM_CUSTOM || USE_ALLOCATOR_WRAP
+    printf("Memory (%s, %s allocator): %zu bytes live in %u allocations, %zu bytes peak, %u%% fragmentation, "
+        "%u/%u allocations and %u/%u frees during startup/steady state\n",
+        context, current.name, current.live_bytes, current.live_allocations, current.peak_bytes, current.frag_pct,
+        current.allocations[ALLOCATOR_PHASE_STARTUP], current.allocations[ALLOCATOR_PHASE_STEADY],
+        current.frees[ALLOCATOR_PHASE_STARTUP], current.frees[ALLOCATOR_PHASE_STEADY]);
+#else
+    /* The built-in allocator doesn't count calls without linker wrapping, so there are no per-phase counts */
+    printf("Memory (%s, %s allocator): %zu bytes live in %u allocations, %zu bytes peak, %u%% fragmentation\n",
+        context, current.name, current.live_bytes, current.live_allocations, current.peak_bytes, current.frag_pct);
+#endif /* LV_MEM_CUSTOM || USE_ALLOCATOR_WRAP */
+
+#if USE_ALLOCATOR_WRAP
+    printf("Heap (%s): %u/%u allocations and %u/%u frees outside of LVGL during startup/steady state\n", context,
+        current.heap_allocations[ALLOCATOR_PHASE_STARTUP], current.heap_allocations[ALLOCATOR_PHASE_STEADY],
+        current.heap_frees[ALLOCATOR_PHASE_STARTUP], current.heap_frees[ALLOCATOR_PHASE_STEADY]);
+#endif /* USE_ALLOCATOR_WRAP */
+}
@@ -0,0 +1,106 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+/* NOTE: This header is included from lv_conf.h and must not include any LVGL headers */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Allocation phases */
+typedef enum {
+    /* Everything up to and including the first frame */
+    ALLOCATOR_PHASE_STARTUP = 0,
+    /* Everything after the first frame */
+    ALLOCATOR_PHASE_STEADY = 1,
+    ALLOCATOR_NUM_PHASES
+} allocator_phase_t;
+
+/**
+ * Memory statistics
+ */
+typedef struct {
+    /* Name of the allocator in use */
+    const char *name;
+    /* Bytes currently allocated */
+    size_t live_bytes;
+    /* Highest number of bytes allocated at the same time */
+    size_t peak_bytes;
+    /* Number of allocations currently alive */
+    uint32_t live_allocations;
+    /* Fragmentation in percent */
+    uint8_t frag_pct;
+    /* Number of LVGL allocations per phase, the built-in allocator is only counted with linker wrapping */
+    uint32_t allocations[ALLOCATOR_NUM_PHASES];
+    /* Number of LVGL frees per phase, the built-in allocator is only counted with linker wrapping */
+    uint32_t frees[ALLOCATOR_NUM_PHASES];
+    /* Number of malloc, calloc and realloc calls from the program per phase, only counted with linker wrapping */
+    uint32_t heap_allocations[ALLOCATOR_NUM_PHASES];
+    /* Number of free calls from the program per phase, only counted with linker wrapping */
+    uint32_t heap_frees[ALLOCATOR_NUM_PHASES];
+} allocator_stats;
+
+/**
+ * Allocate memory. Used as LV_MEM_CUSTOM_ALLOC, only available with a custom allocator.
+ *
+ * @param size number of bytes to allocate
+ * @return pointer to the allocated memory or NULL on failure
+ */
+void *allocator_alloc(size_t size);
+
+/**
+ * Free memory allocated with allocator_alloc or allocator_realloc. Used as LV_MEM_CUSTOM_FREE.
+ *
+ * @param ptr pointer to the memory to free, may be NULL
+ */
+void allocator_free(void *ptr);
+
+/**
+ * Resize memory allocated with allocator_alloc or allocator_realloc. Used as LV_MEM_CUSTOM_REALLOC.
+ *
+ * @param ptr pointer to the memory to resize, may be NULL
+ * @param size new size in bytes
+ * @return pointer to the resized memory or NULL on failure
+ */
+void *allocator_realloc(void *ptr, size_t size);
+
+/**
+ * End the startup phase. Called once after the first frame, freezes the init-time arena (if any) and
+ * logs the startup statistics.
+ */
+void allocator_end_startup(void);
+
+/**
+ * Retrieve the current memory statistics.
+ *
+ * @param stats pointer for writing the statistics into
+ */
+void allocator_get_stats(allocator_stats *stats);
+
+/**
+ * Print the current memory statistics.
+ *
+ * @param context short description of when the statistics were taken
+ */
+void allocator_log_stats(const char *context);
+
+#endif /* ALLOCATOR_H */
@@ -0,0 +1,485 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "backlight.h"
+
+#include "event_loop.h"
+
+#include "lvgl/lvgl.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+
+/**
+ * Static variables
+ */
+
+#define BACKLIGHT_CLASS_DIR "/sys/class/backlight"
+#define LEDS_CLASS_DIR "/sys/class/leds"
+#define LEDS_DEFAULT_NAME "lcd-backlight"
+
+/* Backlight types in order of preference, see sysfs-class-backlight */
+static const char *backlight_types[] = { "firmware", "platform", "raw" };
+
+static backlight_policy current_policy;
+
+static int brightness_fd = -1;
+static int max_brightness = 0;
+static int original_brightness = -1;
+/* Last value written to (or read from) sysfs */
+static int written_brightness = -1;
+
+static int ramp_fd = -1;
+static int ramp_target = 0;
+static int ramp_steps_left = 0;
+
+static int dim_fd = -1;
+static bool is_enabled = false;
+static bool is_dimmed = false;
+static int battery_capacity = 100;
+static bool is_battery_full = false;
+
+static backlight_change_cb_t change_cb = NULL;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Read an integer from a sysfs attribute.
+ *
+ * @param dir device directory
+ * @param name attribute name
+ * @param value pointer for writing the value into
+ * @return true on success, false otherwise
+ */
+static bool read_attribute(const char *dir, const char *name, int *value);
+
+/**
+ * Find the preferred device in the backlight class, falling back to the LED class.
+ *
+ * @param dir buffer for writing the device directory into
+ * @param size size of the buffer
+ * @return true if a device was found, false otherwise
+ */
+static bool find_device(char *dir, size_t size);
+
+/**
+ * Write a raw brightness value unless it is already set.
+ *
+ * @param brightness raw brightness
+ */
+static void write_brightness(int brightness);
+
+/**
+ * Compute the brightness the policy asks for in the current state.
+ *
+ * @return brightness in percent of the maximum
+ */
+static uint8_t get_policy_pct(void);
+
+/**
+ * Compute the raw brightness the policy asks for in the current state.
+ *
+ * @return raw brightness
+ */
+static int get_policy_brightness(void);
+
+/**
+ * Convert a percentage of the maximum brightness into a raw value.
+ *
+ * @param pct percentage
+ * @return raw brightness, at least 1 for non-zero percentages
+ */
+static int pct_to_raw(uint8_t pct);
+
+/**
+ * Move to a new brightness, either right away or in a few timer driven steps.
+ *
+ * @param target raw brightness to reach
+ * @param is_ramped true to ramp, false to set the brightness immediately
+ */
+static void move_to(int target, bool is_ramped);
+
+/**
+ * Handle a step of the current ramp.
+ *
+ * @param fd timer file descriptor
+ * @param events is unused
+ * @param user_data is unused
+ */
+static void handle_ramp_step(int fd, uint32_t events, void *user_data);
+
+/**
+ * Handle expiry of the dim timer.
+ *
+ * @param fd timer file descriptor
+ * @param events is unused
+ * @param user_data is unused
+ */
+static void handle_dim_timer(int fd, uint32_t events, void *user_data);
+
+/**
+ * Arm or disarm a timer.
+ *
+ * @param fd timer file descriptor
+ * @param value_ms time until the first expiry, 0 to disarm
+ * @param interval_ms interval of subsequent expiries, 0 for a one shot timer
+ */
+static void arm_timer(int fd, uint32_t value_ms, uint32_t interval_ms);
+
+/**
+ * Create a timer on the event loop.
+ *
+ * @param cb callback to invoke on expiry
+ * @return timer file descriptor or -1 on failure
+ */
+static int create_timer(event_loop_cb_t cb);
+
+
+/**
+ * Static functions
+ */
+
+static bool read_attribute(const char *dir, const char *name, int *value) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    char buffer[16];
+    ssize_t len = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (len <= 0) {
+        return false;
+    }
+    buffer[len] = '\0';
+
+    *value = atoi(buffer);
+    return true;
+}
+
+static bool find_device(char *dir, size_t size) {
+    int best_rank = -1;
+
+    DIR *class_dir = opendir(BACKLIGHT_CLASS_DIR);
+    if (class_dir) {
+        struct dirent *entry;
+        while ((entry = readdir(class_dir)) != NULL) {
+            if (entry->d_name[0] == '.') {
+                continue;
+            }
+
+            char path[PATH_MAX];
+            snprintf(path, sizeof(path), "%s/%s/type", BACKLIGHT_CLASS_DIR, entry->d_name);
+            FILE *file = fopen(path, "r");
+            if (file == NULL) {
+                continue;
+            }
+            char type[16] = "";
+            if (fscanf(file, "%15s", type) != 1) {
+                type[0] = '\0';
+            }
+            fclose(file);
+
+            /* Lower ranks are preferred, unknown types come last */
+            int rank = sizeof(backlight_types) / sizeof(backlight_types[0]);
+            for (int i = 0; i < (int)(sizeof(backlight_types) / sizeof(backlight_types[0])); ++i) {
+                if (strcmp(type, backlight_types[i]) == 0) {
+                    rank = i;
+                }
+            }
+
+            if (best_rank < 0 || rank < best_rank) {
+                best_rank = rank;
+                snprintf(dir, size, "%s/%s", BACKLIGHT_CLASS_DIR, entry->d_name);
+            }
+        }
+        closedir(class_dir);
+    }
+
+    if (best_rank >= 0) {
+        return true;
+    }
+
+    /* Android devices usually only expose the panel through the LED class */
+    snprintf(dir, size, "%s/%s", LEDS_CLASS_DIR, LEDS_DEFAULT_NAME);
+    if (access(dir, F_OK) == 0) {
+        return true;
+    }
+
+    class_dir = opendir(LEDS_CLASS_DIR);
+    if (class_dir == NULL) {
+        return false;
+    }
+
+    bool is_found = false;
+    struct dirent *entry;
+    while ((entry = readdir(class_dir)) != NULL && !is_found) {
+        if (strstr(entry->d_name, "backlight") != NULL) {
+            snprintf(dir, size, "%s/%s", LEDS_CLASS_DIR, entry->d_name);
+            is_found = true;
+        }
+    }
+    closedir(class_dir);
+
+    return is_found;
+}
+
+static void write_brightness(int brightness) {
+    if (brightness_fd < 0 || brightness == written_brightness) {
+        return;
+    }
+
+    char buffer[16];
+    int len = snprintf(buffer, sizeof(buffer), "%d", brightness);
+    if (pwrite(brightness_fd, buffer, len, 0) != len) {
+        perror("Failed to write brightness");
+        return;
+    }
+
+    written_brightness = brightness;
+}
+
+static uint8_t get_policy_pct(void) {
+    if (!is_enabled) {
+        return 0;
+    }
+
+    uint8_t pct = current_policy.brightness;
+    if (is_dimmed) {
+        pct = LV_MIN(pct, current_policy.dim_brightness);
+    }
+    if (current_policy.low_battery_brightness > 0 && battery_capacity <= current_policy.low_battery_threshold) {
+        pct = LV_MIN(pct, current_policy.low_battery_brightness);
+    }
+    if (current_policy.full_brightness > 0 && is_battery_full) {
+        pct = LV_MIN(pct, current_policy.full_brightness);
+    }
+
+    return pct;
+}
+
+static int get_policy_brightness(void) {
+    return pct_to_raw(get_policy_pct());
+}
+
+static int pct_to_raw(uint8_t pct) {
+    if (pct == 0) {
+        return 0;
+    }
+
+    int raw = max_brightness * LV_MIN(pct, 100) / 100;
+    return raw > 0 ? raw : 1;
+}
+
+static void move_to(int target, bool is_ramped) {
+    ramp_target = target;
+
+    if (change_cb) {
+        change_cb(get_policy_pct());
+    }
+
+    int current = written_brightness >= 0 ? written_brightness : target;
+    if (!is_ramped || ramp_fd < 0 || current == target) {
+        ramp_steps_left = 0;
+        arm_timer(ramp_fd, 0, 0);
+        write_brightness(target);
+        return;
+    }
+
+    ramp_steps_left = BACKLIGHT_RAMP_STEPS;
+    arm_timer(ramp_fd, BACKLIGHT_RAMP_INTERVAL_MS, BACKLIGHT_RAMP_INTERVAL_MS);
+}
+
+static void handle_ramp_step(int fd, uint32_t events, void *user_data) {
+    (void)events;
+    (void)user_data;
+
+    uint64_t expirations;
+    if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations) || ramp_steps_left <= 0) {
+        return;
+    }
+
+    /* Cover the remaining distance in equal parts, the last step lands on the target exactly */
+    int current = written_brightness >= 0 ? written_brightness : ramp_target;
+    write_brightness(current + (ramp_target - current) / ramp_steps_left);
+
+    if (--ramp_steps_left == 0) {
+        arm_timer(ramp_fd, 0, 0);
+    }
+}
+
+static void handle_dim_timer(int fd, uint32_t events, void *user_data) {
+    (void)events;
+    (void)user_data;
+
+    uint64_t expirations;
+    if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return;
+    }
+
+    is_dimmed = true;
+    move_to(get_policy_brightness(), true);
+}
+
+static void arm_timer(int fd, uint32_t value_ms, uint32_t interval_ms) {
+    if (fd < 0) {
+        return;
+    }
+
+    struct itimerspec spec = {
+        .it_interval = { .tv_sec = interval_ms / 1000, .tv_nsec = (interval_ms % 1000) * 1000000L },
+        .it_value = { .tv_sec = value_ms / 1000, .tv_nsec = (value_ms % 1000) * 1000000L }
+    };
+    timerfd_settime(fd, 0, &spec, NULL);
+}
+
+static int create_timer(event_loop_cb_t cb) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        perror("Failed to create backlight timer");
+        return -1;
+    }
+
+    if (!event_loop_add_fd(fd, EPOLLIN, cb, NULL)) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+
+/**
+ * Public functions
+ */
+
+bool backlight_init(const backlight_policy *policy) {
+    current_policy = *policy;
+
+    /* Dimming also applies without a device, the level is then rendered in software */
+    if (current_policy.dim_timeout > 0) {
+        dim_fd = create_timer(handle_dim_timer);
+    }
+
+    char dir[PATH_MAX];
+    if (!find_device(dir, sizeof(dir))) {
+        printf("No backlight device found\n");
+        return false;
+    }
+
+    if (!read_attribute(dir, "max_brightness", &max_brightness) || max_brightness <= 0) {
+        printf("Failed to read max brightness of %s\n", dir);
+        return false;
+    }
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/brightness", dir);
+    brightness_fd = open(path, O_RDWR | O_CLOEXEC);
+    if (brightness_fd < 0) {
+        printf("Failed to open %s\n", path);
+        return false;
+    }
+
+    if (read_attribute(dir, "brightness", &original_brightness)) {
+        written_brightness = original_brightness;
+    }
+
+    ramp_fd = create_timer(handle_ramp_step);
+
+    printf("Using backlight %s (max %d)\n", dir, max_brightness);
+    return true;
+}
+
+bool backlight_is_available(void) {
+    return brightness_fd >= 0;
+}
+
+void backlight_set_enabled(bool enabled) {
+    is_enabled = enabled;
+    is_dimmed = false;
+
+    if (is_enabled) {
+        arm_timer(dim_fd, current_policy.dim_timeout * 1000U, 0);
+    } else {
+        arm_timer(dim_fd, 0, 0);
+    }
+
+    /* Waking up must not be delayed by a ramp */
+    move_to(get_policy_brightness(), !is_enabled);
+}
+
+void backlight_activity(void) {
+    if (!is_enabled) {
+        return;
+    }
+
+    arm_timer(dim_fd, current_policy.dim_timeout * 1000U, 0);
+    if (is_dimmed) {
+        is_dimmed = false;
+        move_to(get_policy_brightness(), true);
+    }
+}
+
+void backlight_set_battery(int capacity, bool is_full) {
+    battery_capacity = capacity;
+    is_battery_full = is_full;
+
+    int target = get_policy_brightness();
+    if (target != ramp_target) {
+        move_to(target, true);
+    }
+}
+
+bool backlight_is_dimmed(void) {
+    return is_enabled && is_dimmed;
+}
+
+void backlight_set_change_cb(backlight_change_cb_t cb) {
+    change_cb = cb;
+}
+
+uint8_t backlight_get_target_pct(void) {
+    return get_policy_pct();
+}
+
+void backlight_restore(void) {
+    arm_timer(ramp_fd, 0, 0);
+    arm_timer(dim_fd, 0, 0);
+    ramp_steps_left = 0;
+
+    if (original_brightness >= 0) {
+        write_brightness(original_brightness);
+    }
+}
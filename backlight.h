@@ -0,0 +1,119 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BACKLIGHT_H
+#define BACKLIGHT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Number of steps of a brightness ramp */
+#define BACKLIGHT_RAMP_STEPS 4
+/* Time between two steps of a brightness ramp in ms */
+#define BACKLIGHT_RAMP_INTERVAL_MS 16
+
+/**
+ * Brightness policy, all brightness values are in percent of the maximum
+ */
+typedef struct {
+    /* Brightness while the display is on */
+    uint8_t brightness;
+    /* Seconds without activity after which the display is dimmed, 0 to disable */
+    uint16_t dim_timeout;
+    /* Brightness while dimmed */
+    uint8_t dim_brightness;
+    /* Capacity (in percent) at or below which the battery is considered low */
+    uint8_t low_battery_threshold;
+    /* Brightness while the battery is low, 0 to disable */
+    uint8_t low_battery_brightness;
+    /* Brightness once the battery is full, 0 to disable */
+    uint8_t full_brightness;
+} backlight_policy;
+
+/**
+ * Callback for changes of the policy's brightness
+ *
+ * @param pct new brightness in percent of the maximum, 0 if the backlight is turned off
+ */
+typedef void (*backlight_change_cb_t)(uint8_t pct);
+
+/**
+ * Find the backlight device, remember its current brightness and prepare the ramp and dim timers
+ * on the event loop. Requires event_loop_init to have been called.
+ *
+ * @param policy brightness policy to apply
+ * @return true if a backlight device was found, false otherwise
+ */
+bool backlight_init(const backlight_policy *policy);
+
+/**
+ * Check whether a backlight device was found.
+ *
+ * @return true if the brightness can be controlled, false otherwise
+ */
+bool backlight_is_available(void);
+
+/**
+ * Turn the backlight on or off. Turning it on is immediate, turning it off is ramped.
+ *
+ * @param is_enabled true to apply the policy's brightness, false to turn the backlight off
+ */
+void backlight_set_enabled(bool is_enabled);
+
+/**
+ * Record activity. Undims the display and restarts the dim timer.
+ */
+void backlight_activity(void);
+
+/**
+ * Update the battery state that the policy depends on. Ramps to the new brightness if it changed.
+ *
+ * @param capacity battery capacity in percent
+ * @param is_full true if the battery reports being full
+ */
+void backlight_set_battery(int capacity, bool is_full);
+
+/**
+ * Check whether the display is currently dimmed for lack of activity.
+ *
+ * @return true if dimmed, false otherwise
+ */
+bool backlight_is_dimmed(void);
+
+/**
+ * Set a callback for changes of the policy's brightness. It is also called if no device was found.
+ *
+ * @param cb callback, may be called with an unchanged brightness
+ */
+void backlight_set_change_cb(backlight_change_cb_t cb);
+
+/**
+ * Get the brightness the policy asks for in the current state, also if no device was found.
+ *
+ * @return brightness in percent of the maximum
+ */
+uint8_t backlight_get_target_pct(void);
+
+/**
+ * Restore the brightness from before backlight_init without ramping. Used on teardown.
+ */
+void backlight_restore(void);
+
+#endif /* BACKLIGHT_H */
@@ -0,0 +1,242 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "charge_animation.h"
+
+#include "steady_state.h"
+#include "trace.h"
+
+#include <stdio.h>
+#include <time.h>
+
+
+/**
+ * Static variables
+ */
+
+/* Highest opacity of the band, reached halfway through a cycle */
+#define CHARGE_ANIMATION_MAX_OPA LV_OPA_40
+
+static lv_obj_t *animated_fill = NULL;
+static lv_obj_t *band = NULL;
+static lv_timer_t *timer = NULL;
+static bool is_animating = false;
+static uint32_t start_tick = 0;
+static int last_step = -1;
+static lv_coord_t last_y = -1;
+static lv_opa_t last_opa = LV_OPA_TRANSP;
+
+/* Band position in 1/1024 of the travel and opacity per step */
+static uint16_t position_lut[CHARGE_ANIMATION_STEPS];
+static lv_opa_t opa_lut[CHARGE_ANIMATION_STEPS];
+
+static uint32_t num_frames = 0;
+static int64_t frame_us = 0;
+static int64_t max_frame_us = 0;
+static int64_t animated_us = 0;
+static int64_t animated_cpu_us = 0;
+static int64_t active_since_us = 0;
+static int64_t active_since_cpu_us = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Ease a value with a smoothstep curve.
+ *
+ * @param x value in 1/1024 units (0 - 1024)
+ * @return eased value in 1/1024 units
+ */
+static uint32_t smoothstep(uint32_t x);
+
+/**
+ * Fill the position and opacity tables.
+ */
+static void build_luts(void);
+
+/**
+ * Read a clock.
+ *
+ * @param clock_id clock to read
+ * @return time in microseconds
+ */
+static int64_t read_clock_us(clockid_t clock_id);
+
+/**
+ * Record that the band's area is redrawn on purpose. The band never leaves the fill.
+ */
+static void mark_band_change(void);
+
+/**
+ * Move the band to the current step.
+ *
+ * @param t timer
+ */
+static void animate(lv_timer_t *t);
+
+
+/**
+ * Static functions
+ */
+
+static uint32_t smoothstep(uint32_t x) {
+    /* 3x^2 - 2x^3 in fixed point */
+    return (x * x * (3 * 1024 - 2 * x)) >> 20;
+}
+
+static void build_luts(void) {
+    for (uint32_t i = 0; i < CHARGE_ANIMATION_STEPS; ++i) {
+        uint32_t t = i * 1024 / CHARGE_ANIMATION_STEPS;
+        position_lut[i] = (uint16_t)smoothstep(t);
+
+        /* Fade in over the first half of the cycle and out over the second */
+        uint32_t triangle = t < 512 ? t * 2 : (1024 - t) * 2;
+        opa_lut[i] = (lv_opa_t)(smoothstep(triangle) * CHARGE_ANIMATION_MAX_OPA / 1024);
+    }
+}
+
+static int64_t read_clock_us(clockid_t clock_id) {
+    struct timespec ts;
+    clock_gettime(clock_id, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void mark_band_change(void) {
+    lv_area_t area;
+    lv_obj_get_coords(animated_fill, &area);
+    steady_state_mark_area_change(&area);
+}
+
+static void animate(lv_timer_t *t) {
+    LV_UNUSED(t);
+
+    int step = (int)(lv_tick_elaps(start_tick) % CHARGE_ANIMATION_CYCLE_MS * CHARGE_ANIMATION_STEPS / CHARGE_ANIMATION_CYCLE_MS);
+    if (step == last_step) {
+        return;
+    }
+    last_step = step;
+
+    /* Rise from the bottom of the fill to its top, hide the band if the fill is too small */
+    lv_coord_t travel = lv_obj_get_content_height(animated_fill) - CHARGE_ANIMATION_BAND_HEIGHT;
+    if (travel <= 0) {
+        if (!lv_obj_has_flag(band, LV_OBJ_FLAG_HIDDEN)) {
+            lv_obj_add_flag(band, LV_OBJ_FLAG_HIDDEN);
+            last_y = -1;
+            mark_band_change();
+        }
+        return;
+    }
+
+    /* The eased ends of the cycle repeat positions and opacities, those steps don't redraw anything */
+    lv_coord_t y = travel - (lv_coord_t)(travel * position_lut[step] / 1024);
+    lv_opa_t opa = opa_lut[step];
+    if (y == last_y && opa == last_opa && !lv_obj_has_flag(band, LV_OBJ_FLAG_HIDDEN)) {
+        return;
+    }
+
+    int64_t start_us = trace_now_us();
+
+    /* Both changes only invalidate the band's old and new area */
+    lv_obj_clear_flag(band, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_set_y(band, y);
+    lv_obj_set_style_bg_opa(band, opa, LV_PART_MAIN);
+    last_y = y;
+    last_opa = opa;
+    mark_band_change();
+
+    /* Render and flush of the frame happen in LVGL's refresh and are accounted in the CPU time */
+    int64_t elapsed_us = trace_now_us() - start_us;
+    frame_us += elapsed_us;
+    max_frame_us = LV_MAX(max_frame_us, elapsed_us);
+    ++num_frames;
+}
+
+
+/**
+ * Public functions
+ */
+
+void charge_animation_init(lv_obj_t *fill, uint8_t fps) {
+    animated_fill = fill;
+    build_luts();
+
+    band = lv_obj_create(fill);
+    lv_obj_set_size(band, LV_PCT(100), CHARGE_ANIMATION_BAND_HEIGHT);
+    /* Every property the animation changes exists from the start, adding one would allocate mid-animation */
+    lv_obj_set_y(band, 0);
+    lv_obj_set_style_bg_color(band, lv_color_white(), LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(band, LV_OPA_TRANSP, LV_PART_MAIN);
+    lv_obj_set_style_radius(band, LV_RADIUS_CIRCLE, LV_PART_MAIN);
+    lv_obj_set_style_border_width(band, 0, LV_PART_MAIN);
+    lv_obj_set_style_pad_all(band, 0, LV_PART_MAIN);
+    lv_obj_clear_flag(band, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(band, LV_OBJ_FLAG_HIDDEN);
+
+    timer = lv_timer_create(animate, 1000 / LV_MAX(fps, 1), NULL);
+    lv_timer_pause(timer);
+}
+
+void charge_animation_set_active(bool is_active) {
+    if (timer == NULL || is_active == is_animating) {
+        return;
+    }
+    is_animating = is_active;
+
+    if (is_animating) {
+        start_tick = lv_tick_get();
+        last_step = -1;
+        active_since_us = read_clock_us(CLOCK_MONOTONIC);
+        active_since_cpu_us = read_clock_us(CLOCK_PROCESS_CPUTIME_ID);
+        lv_timer_resume(timer);
+        lv_timer_ready(timer);
+    } else {
+        lv_timer_pause(timer);
+        if (!lv_obj_has_flag(band, LV_OBJ_FLAG_HIDDEN)) {
+            lv_obj_add_flag(band, LV_OBJ_FLAG_HIDDEN);
+            last_y = -1;
+            mark_band_change();
+        }
+        animated_us += read_clock_us(CLOCK_MONOTONIC) - active_since_us;
+        animated_cpu_us += read_clock_us(CLOCK_PROCESS_CPUTIME_ID) - active_since_cpu_us;
+    }
+}
+
+void charge_animation_log_stats(void) {
+    if (timer == NULL) {
+        return;
+    }
+
+    int64_t total_us = animated_us;
+    int64_t total_cpu_us = animated_cpu_us;
+    if (is_animating) {
+        total_us += read_clock_us(CLOCK_MONOTONIC) - active_since_us;
+        total_cpu_us += read_clock_us(CLOCK_PROCESS_CPUTIME_ID) - active_since_cpu_us;
+    }
+
+    long long cpu_us_per_s = total_us > 0 ? (long long)(total_cpu_us * 1000000 / total_us) : 0;
+    long long cpu_us_per_frame = num_frames > 0 ? (long long)(total_cpu_us / num_frames) : 0;
+    long long update_us_per_frame = num_frames > 0 ? (long long)(frame_us / num_frames) : 0;
+    printf("Charging animation %s: %llds animated, %u frames, %lld.%01lldms CPU per animated second, "
+        "%lldus CPU per frame, %lldus (max %lldus) per band update\n",
+        is_animating ? "running" : "stopped", (long long)(total_us / 1000000), num_frames, cpu_us_per_s / 1000,
+        (cpu_us_per_s % 1000) / 100, cpu_us_per_frame, update_us_per_frame, (long long)max_frame_us);
+}
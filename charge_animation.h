@@ -0,0 +1,58 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CHARGE_ANIMATION_H
+#define CHARGE_ANIMATION_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Number of precomputed animation steps per cycle */
+#define CHARGE_ANIMATION_STEPS 64
+/* Duration of a cycle in ms, independent of the frame rate */
+#define CHARGE_ANIMATION_CYCLE_MS 2400
+/* Height of the rising band in pixels */
+#define CHARGE_ANIMATION_BAND_HEIGHT 48
+
+/**
+ * Prepare a band that rises through the battery fill while charging. The animation starts
+ * inactive.
+ *
+ * @param fill battery fill object to animate inside of
+ * @param fps maximum number of frames per second
+ */
+void charge_animation_init(lv_obj_t *fill, uint8_t fps);
+
+/**
+ * Start or stop the animation. While stopped, the band is hidden and its timer is paused.
+ *
+ * @param is_active true to animate, false to stop
+ */
+void charge_animation_set_active(bool is_active);
+
+/**
+ * Print the animated time, the number of frames, the CPU time used per animated second and per
+ * frame and the time spent updating the band per frame.
+ */
+void charge_animation_log_stats(void);
+
+#endif /* CHARGE_ANIMATION_H */
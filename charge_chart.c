@@ -0,0 +1,169 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "charge_chart.h"
+
+#include "steady_state.h"
+#include "theme.h"
+#include "trace.h"
+
+#include <stdio.h>
+
+
+/**
+ * Static variables
+ */
+
+static lv_obj_t *chart = NULL;
+
+/* Ring of capacities, indexed by column */
+static uint8_t *history = NULL;
+static uint16_t num_columns = 0;
+static uint16_t num_filled = 0;
+static uint16_t next_column = 0;
+static int64_t last_sample_us = -1;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Draw the columns that intersect the area being redrawn.
+ *
+ * @param e draw event
+ */
+static void draw_columns(lv_event_t *e);
+
+/**
+ * Invalidate a single column.
+ *
+ * @param column column index
+ */
+static void invalidate_column(uint16_t column);
+
+
+/**
+ * Static functions
+ */
+
+static void draw_columns(lv_event_t *e) {
+    lv_obj_t *obj = lv_event_get_target(e);
+#if LVGL_VERSION_MAJOR == 8 && LVGL_VERSION_MINOR >= 2
+    lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+    const lv_area_t *clip_area = draw_ctx->clip_area;
+#else
+    const lv_area_t *clip_area = lv_event_get_param(e);
+#endif
+
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+
+    /* Only visit the columns inside the clip area, an appended sample costs the same at any length */
+    int first = LV_MAX(0, (clip_area->x1 - coords.x1) / CHARGE_CHART_COLUMN_WIDTH);
+    int last = LV_MIN(num_filled - 1, (clip_area->x2 - coords.x1) / CHARGE_CHART_COLUMN_WIDTH);
+
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_opa = LV_OPA_COVER;
+
+    for (int column = first; column <= last; ++column) {
+        /* The column about to be overwritten stays blank to mark the sweep position */
+        if (num_filled == num_columns && column == next_column) {
+            continue;
+        }
+
+        uint8_t capacity = history[column];
+        lv_area_t bar = {
+            .x1 = coords.x1 + column * CHARGE_CHART_COLUMN_WIDTH,
+            .x2 = coords.x1 + column * CHARGE_CHART_COLUMN_WIDTH + CHARGE_CHART_COLUMN_WIDTH - 2,
+            .y1 = coords.y2 - LV_MAX(1, capacity * CHARGE_CHART_HEIGHT / 100) + 1,
+            .y2 = coords.y2
+        };
+        dsc.bg_color = theme_get_fill_color(capacity);
+#if LVGL_VERSION_MAJOR == 8 && LVGL_VERSION_MINOR >= 2
+        lv_draw_rect(draw_ctx, &dsc, &bar);
+#else
+        lv_draw_rect(&bar, clip_area, &dsc);
+#endif
+    }
+}
+
+static void invalidate_column(uint16_t column) {
+    lv_area_t coords;
+    lv_obj_get_coords(chart, &coords);
+
+    lv_area_t area = {
+        .x1 = coords.x1 + column * CHARGE_CHART_COLUMN_WIDTH,
+        .x2 = coords.x1 + column * CHARGE_CHART_COLUMN_WIDTH + CHARGE_CHART_COLUMN_WIDTH - 1,
+        .y1 = coords.y1,
+        .y2 = coords.y2
+    };
+    lv_obj_invalidate_area(chart, &area);
+}
+
+
+/**
+ * Public functions
+ */
+
+lv_obj_t *charge_chart_init(lv_obj_t *parent) {
+    num_columns = (uint16_t)(lv_disp_get_hor_res(NULL) * 3 / 4 / CHARGE_CHART_COLUMN_WIDTH);
+    history = lv_mem_alloc(num_columns);
+    if (history == NULL) {
+        printf("Failed to allocate charge history\n");
+        return NULL;
+    }
+
+    chart = lv_obj_create(parent);
+    lv_obj_remove_style_all(chart);
+    lv_obj_set_size(chart, num_columns * CHARGE_CHART_COLUMN_WIDTH, CHARGE_CHART_HEIGHT);
+    lv_obj_clear_flag(chart, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(chart, draw_columns, LV_EVENT_DRAW_MAIN, NULL);
+
+    return chart;
+}
+
+void charge_chart_sample(int capacity) {
+    if (chart == NULL) {
+        return;
+    }
+
+    int64_t now_us = trace_now_us();
+    /* Tolerate a quarter interval of jitter, a sampler wakeup may come a little before the column is due */
+    if (last_sample_us >= 0 && now_us - last_sample_us < CHARGE_CHART_INTERVAL_S * 750000LL) {
+        return;
+    }
+    last_sample_us = now_us;
+
+    uint16_t column = next_column;
+    history[column] = (uint8_t)LV_CLAMP(0, capacity, 100);
+    next_column = (next_column + 1) % num_columns;
+    if (num_filled < num_columns) {
+        ++num_filled;
+    }
+
+    /* The new column and, once the chart has wrapped, the blank one that moved along */
+    invalidate_column(column);
+    if (num_filled == num_columns) {
+        invalidate_column(next_column);
+    }
+    steady_state_mark_change();
+}
@@ -0,0 +1,51 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CHARGE_CHART_H
+#define CHARGE_CHART_H
+
+#include "lvgl/lvgl.h"
+
+/* Time between two columns of the chart in seconds */
+#define CHARGE_CHART_INTERVAL_S 60
+/* Width of a column in pixels, including a 1 pixel gap */
+#define CHARGE_CHART_COLUMN_WIDTH 3
+/* Height of the chart in pixels */
+#define CHARGE_CHART_HEIGHT 120
+
+/**
+ * Create a chart of the capacity over the session. The chart spans three quarters of the display's
+ * width with one column per sample. Once it is full, new columns overwrite the oldest ones from the
+ * left, with a blank column marking the sweep position. Appending a sample only redraws two columns.
+ *
+ * @param parent object to create the chart in
+ * @return the chart object or NULL if its history could not be allocated
+ */
+lv_obj_t *charge_chart_init(lv_obj_t *parent);
+
+/**
+ * Offer a sample to the chart. Samples closer than three quarters of CHARGE_CHART_INTERVAL_S to the
+ * previous one are dropped.
+ *
+ * @param capacity battery capacity in percent
+ */
+void charge_chart_sample(int capacity);
+
+#endif /* CHARGE_CHART_H */
@@ -0,0 +1,178 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "charge_estimator.h"
+
+#include "power_supply.h"
+#include "trace.h"
+
+#include <stdlib.h>
+
+
+/**
+ * Static variables
+ */
+
+/* Level of a full battery in thousandths of a percent */
+#define FULL_LEVEL 100000
+/* Weight of a new current sample in 1/16 */
+#define CURRENT_EWMA_WEIGHT 4
+
+typedef struct {
+    /* Seconds since the first sample of the session */
+    int64_t time_s;
+    /* Level in thousandths of a percent */
+    int64_t level;
+} sample;
+
+static sample samples[CHARGE_ESTIMATOR_SAMPLES];
+static int num_samples = 0;
+static int next_sample = 0;
+static int64_t origin_us = -1;
+static int64_t last_sample_us = -1;
+
+/* Running sums over the samples in the ring, updated as samples enter and leave */
+static int64_t sum_t = 0;
+static int64_t sum_l = 0;
+static int64_t sum_tt = 0;
+static int64_t sum_tl = 0;
+
+/* Latest charge in uAh and smoothed charging current in uA, -1 if unknown */
+static int64_t charge_now = -1;
+static int64_t charge_full = -1;
+static int64_t current_ewma = -1;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Add a sample to the ring and the running sums, evicting the oldest one if the ring is full.
+ *
+ * @param s sample to add
+ */
+static void add_sample(sample s);
+
+
+/**
+ * Static functions
+ */
+
+static void add_sample(sample s) {
+    if (num_samples == CHARGE_ESTIMATOR_SAMPLES) {
+        sample old = samples[next_sample];
+        sum_t -= old.time_s;
+        sum_l -= old.level;
+        sum_tt -= old.time_s * old.time_s;
+        sum_tl -= old.time_s * old.level;
+    } else {
+        ++num_samples;
+    }
+
+    samples[next_sample] = s;
+    next_sample = (next_sample + 1) % CHARGE_ESTIMATOR_SAMPLES;
+
+    sum_t += s.time_s;
+    sum_l += s.level;
+    sum_tt += s.time_s * s.time_s;
+    sum_tl += s.time_s * s.level;
+}
+
+
+/**
+ * Public functions
+ */
+
+void charge_estimator_sample(int capacity) {
+    int64_t now_us = trace_now_us();
+    /* Samples taken along with another one arrive slightly early, only drop those well inside the interval */
+    if (last_sample_us >= 0 && now_us - last_sample_us < CHARGE_ESTIMATOR_INTERVAL_S * 750000LL) {
+        return;
+    }
+    last_sample_us = now_us;
+    if (origin_us < 0) {
+        origin_us = now_us;
+    }
+
+    /* Prefer the gauge's charge, it has a much finer resolution than the capacity */
+    int64_t level = (int64_t)capacity * 1000;
+    bool has_charge = power_supply_read_int(POWER_SUPPLY_CHARGE_NOW, &charge_now)
+        && power_supply_read_int(POWER_SUPPLY_CHARGE_FULL, &charge_full) && charge_full > 0;
+    if (has_charge) {
+        level = charge_now * FULL_LEVEL / charge_full;
+    } else {
+        charge_now = -1;
+        charge_full = -1;
+    }
+
+    /* Gauges disagree on the sign of the charging current */
+    int64_t current;
+    if (power_supply_read_int(POWER_SUPPLY_CURRENT_NOW, &current)) {
+        current = llabs(current);
+        current_ewma = current_ewma < 0 ? current
+            : current_ewma + (current - current_ewma) * CURRENT_EWMA_WEIGHT / 16;
+    }
+
+    add_sample((sample){ .time_s = (now_us - origin_us) / 1000000, .level = level });
+}
+
+void charge_estimator_reset(void) {
+    num_samples = 0;
+    next_sample = 0;
+    origin_us = -1;
+    last_sample_us = -1;
+    sum_t = 0;
+    sum_l = 0;
+    sum_tt = 0;
+    sum_tl = 0;
+    current_ewma = -1;
+}
+
+int charge_estimator_get_minutes(void) {
+    if (num_samples == 0) {
+        return -1;
+    }
+
+    sample newest = samples[(next_sample + CHARGE_ESTIMATOR_SAMPLES - 1) % CHARGE_ESTIMATOR_SAMPLES];
+    sample oldest = samples[num_samples == CHARGE_ESTIMATOR_SAMPLES ? next_sample : 0];
+    if (newest.level >= FULL_LEVEL) {
+        return 0;
+    }
+
+    /* Least squares slope of the level over time, in thousandths of a percent per second */
+    if (newest.time_s - oldest.time_s >= CHARGE_ESTIMATOR_MIN_SPAN_S) {
+        double n = num_samples;
+        double denominator = n * (double)sum_tt - (double)sum_t * (double)sum_t;
+        if (denominator > 0) {
+            double slope = (n * (double)sum_tl - (double)sum_t * (double)sum_l) / denominator;
+            if (slope > 0) {
+                return (int)((FULL_LEVEL - newest.level) / slope / 60 + 0.5);
+            }
+        }
+    }
+
+    /* Until the level has moved enough, extrapolate from the charging current */
+    if (charge_now >= 0 && current_ewma > 0 && charge_full > charge_now) {
+        return (int)((charge_full - charge_now) * 60 / current_ewma);
+    }
+
+    return -1;
+}
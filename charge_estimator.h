@@ -0,0 +1,55 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CHARGE_ESTIMATOR_H
+#define CHARGE_ESTIMATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Number of samples the regression runs over */
+#define CHARGE_ESTIMATOR_SAMPLES 64
+/* Nominal time between two samples in seconds */
+#define CHARGE_ESTIMATOR_INTERVAL_S 30
+/* Time the samples must span before the regression is trusted, in seconds */
+#define CHARGE_ESTIMATOR_MIN_SPAN_S 300
+
+/**
+ * Offer a sample to the estimator. Samples closer than three quarters of CHARGE_ESTIMATOR_INTERVAL_S
+ * to the previous one are dropped before anything is read. Otherwise the battery's charge and current are read if
+ * the gauge provides them.
+ *
+ * @param capacity battery capacity in percent, used if the gauge doesn't report its charge
+ */
+void charge_estimator_sample(int capacity);
+
+/**
+ * Drop all samples, e.g. when charging stops.
+ */
+void charge_estimator_reset(void);
+
+/**
+ * Estimate the time until the battery is full.
+ *
+ * @return minutes until full or -1 if there is no estimate yet
+ */
+int charge_estimator_get_minutes(void);
+
+#endif /* CHARGE_ESTIMATOR_H */
@@ -0,0 +1,244 @@
+/**
+ * Copyright 2021 Johannes Marbach
+ * Copyright 2024 Bardia Moshiri
+ * Copyright 2024 David Badiei
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "charger_ui.h"
+
+#include "charge_animation.h"
+#include "charge_chart.h"
+#include "charge_estimator.h"
+#include "clock_label.h"
+#include "steady_state.h"
+#include "theme.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+/**
+ * Static variables
+ */
+
+static lv_obj_t *battery_fill = NULL;
+static lv_obj_t *battery_label = NULL;
+static lv_obj_t *time_to_full_label = NULL;
+
+/* Fill width (in percent) for capacities 0 to 12, the rounded corners of the battery need a narrower fill at low levels */
+static const uint8_t fill_width_pct[] = { 100, 80, 82, 83, 84, 86, 88, 89, 91, 92, 94, 96, 98 };
+
+static bool is_ui_visible = true;
+static int displayed_capacity = -1;
+static char battery_label_text[8];
+static int displayed_minutes = -1;
+static char time_to_full_text[32];
+static char displayed_status[16];
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Update the battery level if the capacity changed.
+ *
+ * @param capacity battery capacity in percent
+ * @return true if the capacity changed, false otherwise
+ */
+static bool update_level(int capacity);
+
+/**
+ * Update the time to full if the displayed minutes changed.
+ */
+static void update_time_to_full(void);
+
+/**
+ * Animate the battery fill while charging and the UI is visible.
+ */
+static void update_charge_animation(void);
+
+/**
+ * Check whether the battery is charging.
+ *
+ * @return true if charging, false otherwise
+ */
+static bool is_charging(void);
+
+
+/**
+ * Static functions
+ */
+
+static bool update_level(int capacity) {
+    if (capacity < 0 || capacity > 100 || capacity == displayed_capacity) {
+        return false;
+    }
+
+    // on 100, it goes out of the border radius, because of rounded corners, don't go above 99
+    lv_coord_t height = LV_MIN(capacity, 99) * 8;
+    lv_obj_set_size(battery_fill, LV_PCT(charger_ui_get_fill_width_pct(capacity)), height);
+    lv_obj_align(battery_fill, LV_ALIGN_BOTTOM_MID, 0, 0);
+
+    /* Overwrites the local property set when the fill was created, without allocating */
+    lv_obj_set_style_bg_color(battery_fill, theme_get_fill_color(capacity), LV_PART_MAIN);
+
+    snprintf(battery_label_text, sizeof(battery_label_text), "%d%%", capacity);
+    lv_label_set_text_static(battery_label, battery_label_text);
+
+    displayed_capacity = capacity;
+    steady_state_mark_change();
+    return true;
+}
+
+static void update_time_to_full(void) {
+    int minutes = is_charging() ? charge_estimator_get_minutes() : -1;
+    if (minutes == displayed_minutes) {
+        return;
+    }
+
+    if (minutes < 0) {
+        time_to_full_text[0] = '\0';
+    } else if (minutes < 60) {
+        snprintf(time_to_full_text, sizeof(time_to_full_text), "Full in %d min", minutes);
+    } else {
+        snprintf(time_to_full_text, sizeof(time_to_full_text), "Full in %d h %02d min", minutes / 60, minutes % 60);
+    }
+    lv_label_set_text_static(time_to_full_label, time_to_full_text);
+
+    displayed_minutes = minutes;
+    steady_state_mark_change();
+}
+
+static void update_charge_animation(void) {
+    charge_animation_set_active(is_ui_visible && is_charging() && displayed_capacity < 100);
+}
+
+static bool is_charging(void) {
+    return strcmp(displayed_status, "Charging") == 0;
+}
+
+
+/**
+ * Public functions
+ */
+
+void charger_ui_init(lv_obj_t *parent, const config_opts_general *opts) {
+    /* Battery */
+    lv_obj_t *battery = lv_obj_create(parent);
+    lv_obj_set_size(battery, 400, 800);
+    lv_obj_align(battery, LV_ALIGN_CENTER, 0, 0);
+    lv_obj_set_style_border_width(battery, 5, LV_PART_MAIN);
+    lv_obj_set_style_border_color(battery, lv_color_white(), LV_PART_MAIN);
+    lv_obj_set_style_radius(battery, 60, LV_PART_MAIN);
+    lv_obj_set_style_pad_all(battery, 0, LV_PART_MAIN);
+
+    /* Fill, colored by capacity */
+    battery_fill = lv_obj_create(battery);
+    lv_obj_set_size(battery_fill, LV_PCT(100), LV_PCT(0));
+    lv_obj_align(battery_fill, LV_ALIGN_BOTTOM_MID, 0, 0);
+    lv_obj_set_style_bg_color(battery_fill, theme_get_fill_color(100), LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(battery_fill, LV_OPA_COVER, LV_PART_MAIN);
+    lv_obj_set_style_radius(battery_fill, 55, LV_PART_MAIN);
+    lv_obj_set_style_border_width(battery_fill, 0, LV_PART_MAIN);
+    lv_obj_set_style_pad_all(battery_fill, 5, LV_PART_MAIN);
+
+    /* Battery's tip */
+    lv_obj_t *battery_tip = lv_obj_create(parent);
+    lv_obj_set_size(battery_tip, 140, 45);
+    lv_obj_align(battery_tip, LV_ALIGN_TOP_MID, 0, 745);
+    lv_obj_set_style_border_width(battery_tip, 5, LV_PART_MAIN);
+    lv_obj_set_style_border_color(battery_tip, lv_color_white(), LV_PART_MAIN);
+    lv_obj_set_style_radius(battery_tip, 30, LV_PART_MAIN);
+
+    /* Battery text label */
+    battery_label = lv_label_create(battery);
+    lv_label_set_text(battery_label, "");
+    lv_obj_align(battery_label, LV_ALIGN_CENTER, 0, 0);
+    static lv_style_t style;
+    lv_style_init(&style);
+    lv_style_set_text_font(&style, &lv_font_montserrat_48);
+    lv_obj_add_style(battery_label, &style, 0);
+
+    /* Time to full, centered below the battery with a fixed width so that its area doesn't move */
+    time_to_full_label = lv_label_create(parent);
+    lv_label_set_text_static(time_to_full_label, time_to_full_text);
+    lv_obj_set_width(time_to_full_label, LV_PCT(100));
+    lv_obj_set_style_text_align(time_to_full_label, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    lv_obj_add_style(time_to_full_label, &style, 0);
+    lv_obj_align_to(time_to_full_label, battery, LV_ALIGN_OUT_BOTTOM_MID, 0, 40);
+
+    /* Capacity over the session, below the time to full */
+    if (opts->history_chart) {
+        lv_obj_t *chart = charge_chart_init(parent);
+        if (chart) {
+            lv_obj_align_to(chart, time_to_full_label, LV_ALIGN_OUT_BOTTOM_MID, 0, 20);
+        }
+    }
+
+    if (opts->animations) {
+        charge_animation_init(battery_fill, opts->animation_fps);
+    }
+
+    if (opts->clock_format && !clock_label_init(parent, opts->clock_format)) {
+        printf("Failed to set up the clock\n");
+    }
+}
+
+bool charger_ui_update(int capacity, const char *status) {
+    /* A new status restarts the estimate, it only takes samples while charging */
+    bool has_status_changed = strcmp(status, displayed_status) != 0;
+    if (has_status_changed) {
+        snprintf(displayed_status, sizeof(displayed_status), "%s", status);
+        charge_estimator_reset();
+    }
+
+    if (capacity >= 0 && capacity <= 100) {
+        charge_chart_sample(capacity);
+        if (is_charging()) {
+            charge_estimator_sample(capacity);
+        }
+    }
+    update_time_to_full();
+
+    bool has_level_changed = update_level(capacity);
+    if (has_status_changed || has_level_changed) {
+        update_charge_animation();
+    }
+    return has_level_changed;
+}
+
+void charger_ui_set_visible(bool is_visible) {
+    is_ui_visible = is_visible;
+    update_charge_animation();
+}
+
+void charger_ui_refresh_theme(void) {
+    if (battery_fill && displayed_capacity >= 0) {
+        lv_obj_set_style_bg_color(battery_fill, theme_get_fill_color(displayed_capacity), LV_PART_MAIN);
+    }
+}
+
+int charger_ui_get_capacity(void) {
+    return displayed_capacity;
+}
+
+int charger_ui_get_fill_width_pct(int capacity) {
+    return capacity < (int)(sizeof(fill_width_pct) / sizeof(fill_width_pct[0])) ? fill_width_pct[capacity] : 100;
+}
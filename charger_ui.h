@@ -0,0 +1,79 @@
+/**
+ * Copyright 2021 Johannes Marbach
+ * Copyright 2024 Bardia Moshiri
+ * Copyright 2024 David Badiei
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CHARGER_UI_H
+#define CHARGER_UI_H
+
+#include "config.h"
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+
+/**
+ * Build the battery with its fill and level label and the time to full below it. Depending on the
+ * options, also add the capacity chart, the charging animation and the clock. Requires the theme
+ * to be applied and, for the clock, event_loop_init to have been called.
+ *
+ * @param parent screen to build the UI on
+ * @param opts general options
+ */
+void charger_ui_init(lv_obj_t *parent, const config_opts_general *opts);
+
+/**
+ * Follow a battery sample. Feeds the chart and, while charging, the time to full estimator and
+ * only updates the parts of the UI that changed.
+ *
+ * @param capacity battery capacity in percent, ignored if out of range
+ * @param status battery status (e.g. "Charging" or "Full"), empty if unknown
+ * @return true if the displayed capacity changed, false otherwise
+ */
+bool charger_ui_update(int capacity, const char *status);
+
+/**
+ * Only animate the battery fill while the UI can be seen.
+ *
+ * @param is_visible true if the display is on, false otherwise
+ */
+void charger_ui_set_visible(bool is_visible);
+
+/**
+ * Recolor the battery fill after a theme switch.
+ */
+void charger_ui_refresh_theme(void);
+
+/**
+ * Get the displayed capacity.
+ *
+ * @return capacity in percent or -1 before the first valid sample
+ */
+int charger_ui_get_capacity(void);
+
+/**
+ * Get the width of the battery fill for a given capacity.
+ *
+ * @param capacity battery capacity in percent
+ * @return width in percent of the battery's content width
+ */
+int charger_ui_get_fill_width_pct(int capacity);
+
+#endif /* CHARGER_UI_H */
@@ -0,0 +1,165 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "clock_label.h"
+
+#include "event_loop.h"
+#include "steady_state.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+
+/**
+ * Static variables
+ */
+
+/* Width of the label, fixed so that changing digits don't change the invalidated area */
+#define CLOCK_LABEL_WIDTH 400
+/* Distance of the label from the top of the screen */
+#define CLOCK_LABEL_Y 300
+
+static lv_obj_t *label = NULL;
+static const char *time_format = NULL;
+static char text[32];
+static int timer_fd = -1;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Arm the timer for the next minute boundary and every minute after it.
+ *
+ * @return true on success, false otherwise
+ */
+static bool arm_timer(void);
+
+/**
+ * Format the current time into the label if it changed.
+ */
+static void update_text(void);
+
+/**
+ * Handle expiry or cancellation of the minute timer.
+ *
+ * @param fd timer file descriptor
+ * @param events is unused
+ * @param user_data is unused
+ */
+static void handle_timer(int fd, uint32_t events, void *user_data);
+
+
+/**
+ * Static functions
+ */
+
+static bool arm_timer(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    /* Absolute expiries stay on the minute boundaries, a clock change cancels the timer */
+    struct itimerspec spec = {
+        .it_interval = { .tv_sec = 60 },
+        .it_value = { .tv_sec = (now.tv_sec / 60 + 1) * 60 }
+    };
+    if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, NULL) != 0) {
+        perror("Failed to arm clock timer");
+        return false;
+    }
+
+    return true;
+}
+
+static void update_text(void) {
+    time_t now = time(NULL);
+    struct tm local;
+    if (localtime_r(&now, &local) == NULL) {
+        return;
+    }
+
+    char buffer[sizeof(text)];
+    if (strftime(buffer, sizeof(buffer), time_format, &local) == 0 || strcmp(buffer, text) == 0) {
+        return;
+    }
+
+    /* Setting the text invalidates the label's area and nothing else */
+    strcpy(text, buffer);
+    lv_label_set_text_static(label, text);
+    steady_state_mark_change();
+}
+
+static void handle_timer(int fd, uint32_t events, void *user_data) {
+    (void)events;
+    (void)user_data;
+
+    uint64_t expirations;
+    if (read(fd, &expirations, sizeof(expirations)) < 0) {
+        if (errno != ECANCELED) {
+            return;
+        }
+
+        /* The clock was set, the boundaries moved */
+        tzset();
+        arm_timer();
+    }
+
+    update_text();
+}
+
+
+/**
+ * Public functions
+ */
+
+bool clock_label_init(lv_obj_t *parent, const char *format) {
+    time_format = format;
+
+    timer_fd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd < 0) {
+        perror("Failed to create clock timer");
+        return false;
+    }
+
+    if (!arm_timer() || !event_loop_add_fd(timer_fd, EPOLLIN, handle_timer, NULL)) {
+        close(timer_fd);
+        timer_fd = -1;
+        return false;
+    }
+
+    tzset();
+
+    label = lv_label_create(parent);
+    lv_obj_set_width(label, CLOCK_LABEL_WIDTH);
+    lv_obj_align(label, LV_ALIGN_TOP_MID, 0, CLOCK_LABEL_Y);
+    lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    lv_obj_set_style_text_font(label, &lv_font_montserrat_48, LV_PART_MAIN);
+    lv_label_set_text_static(label, text);
+
+    update_text();
+    return true;
+}
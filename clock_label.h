@@ -0,0 +1,39 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CLOCK_LABEL_H
+#define CLOCK_LABEL_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+
+/**
+ * Show the wall clock in a label that is updated at every minute boundary by a CLOCK_REALTIME
+ * timer on the event loop. The timer is re-armed when the clock is set. Requires event_loop_init
+ * to have been called.
+ *
+ * @param parent object to create the label in
+ * @param format strftime format, must not contain anything finer than minutes
+ * @return true on success, false if the timer could not be set up
+ */
+bool clock_label_init(lv_obj_t *parent, const char *format);
+
+#endif /* CLOCK_LABEL_H */
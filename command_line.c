@@ -63,6 +63,8 @@ static void init_opts(cli_opts *opts) {
     opts->x_offset = 0;
     opts->y_offset = 0;
     opts->verbose = false;
+    opts->trace_file = NULL;
+    opts->check_steady_state = false;
 }
 
 static void print_usage() {
@@ -81,6 +83,10 @@ static void print_usage() {
         "                            vertical pixels, offset horizontally by X\n"
         "                            pixels and vertically by Y pixels\n"
         "  -d  --dpi=N               Override the display's DPI value\n"
+        "  -t, --trace=PATH          Write the startup timeline to PATH in the Chrome\n"
+        "                            trace event format\n"
+        "  -s, --check-steady-state  Exit with failure if a tick without changes\n"
+        "                            allocates, invalidates or flushes anything\n"
         "  -h, --help                Print this message and exit\n"
         "  -V, --version             Print the lvglcharger version and exit\n");
         /*-------------------------------- 78 CHARS --------------------------------*/
@@ -99,6 +105,8 @@ void cli_parse_opts(int argc, char *argv[], cli_opts *opts) {
         { "config-override", required_argument, NULL, 'C' },
         { "geometry",        required_argument, NULL, 'g' },
         { "dpi",             required_argument, NULL, 'd' },
+        { "trace",           required_argument, NULL, 't' },
+        { "check-steady-state", no_argument,    NULL, 's' },
         { "help",            no_argument,       NULL, 'h' },
         { "verbose",         no_argument,       NULL, 'v' },
         { "version",         no_argument,       NULL, 'V' },
@@ -107,7 +115,7 @@ void cli_parse_opts(int argc, char *argv[], cli_opts *opts) {
 
     int opt, index = 0;
 
-    while ((opt = getopt_long(argc, argv, "c:C:g:d:hvV", long_opts, &index)) != -1) {
+    while ((opt = getopt_long(argc, argv, "c:C:g:d:t:shvV", long_opts, &index)) != -1) {
         switch (opt) {
         case 'c':
             opts->config_files[0] = optarg;
@@ -135,6 +143,12 @@ void cli_parse_opts(int argc, char *argv[], cli_opts *opts) {
                 exit(EXIT_FAILURE);
             }
             break;
+        case 't':
+            opts->trace_file = optarg;
+            break;
+        case 's':
+            opts->check_steady_state = true;
+            break;
         case 'h':
             print_usage();
             exit(EXIT_SUCCESS);
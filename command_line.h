@@ -43,6 +43,10 @@ typedef struct {
     int dpi;
     /* Verbose mode. If true, provide more detailed logging output on STDERR. */
     bool verbose;
+    /* Path of the Chrome trace file to write the startup timeline into, NULL to disable */
+    const char *trace_file;
+    /* If true, exit with failure when a tick without changes allocates, invalidates or flushes */
+    bool check_steady_state;
 } cli_opts;
 
 /**
@@ -24,6 +24,7 @@
 
 #include <ini.h>
 #include <stdlib.h>
+#include <string.h>
 
 /**
  * Static prototypes
@@ -55,6 +56,14 @@ static void parse_file(const char *path, config_opts *opts);
  */
 static int parsing_handler(void* user_data, const char* section, const char* key, const char* value);
 
+/**
+ * Parse a percentage, clamping it to 100.
+ *
+ * @param value string to parse
+ * @return parsed percentage
+ */
+static uint8_t parse_pct(const char *value);
+
 /**
  * Attempt to parse a boolean value.
  *
@@ -71,10 +80,30 @@ static bool parse_bool(const char *value, bool *result);
 
 static void init_opts(config_opts *opts) {
     opts->general.animations = false;
+    opts->general.animation_fps = 20;
+    opts->general.history_chart = false;
     opts->general.backend = backends_backends[0] == NULL ? BACKENDS_BACKEND_NONE : 0;
     opts->theme.default_id = THEMES_THEME_BREEZY_DARK;
     opts->theme.alternate_id = THEMES_THEME_BREEZY_LIGHT;
     opts->general.timeout = 0;
+    opts->general.full_action = POWER_POLICY_FULL_NONE;
+    opts->general.display_timeout = 0;
+    opts->general.long_press_command = NULL;
+    opts->general.pixel_shift_interval = 0;
+    opts->general.clock_format = NULL;
+    opts->backlight.brightness = 25;
+    opts->backlight.dim_timeout = 0;
+    opts->backlight.dim_brightness = 10;
+    opts->backlight.low_battery_threshold = 15;
+    opts->backlight.low_battery_brightness = 0;
+    opts->backlight.full_brightness = 0;
+    opts->refresh.rate = 0;
+    opts->refresh.low_rate = 10;
+    opts->refresh.hot_temperature = 45;
+    opts->sampling.online_min_interval = 250;
+    opts->sampling.online_max_interval = 1000;
+    opts->sampling.battery_min_interval = 2000;
+    opts->sampling.battery_max_interval = 30000;
 }
 
 static void parse_file(const char *path, config_opts *opts) {
@@ -91,6 +120,14 @@ static int parsing_handler(void* user_data, const char* section, const char* key
             if (parse_bool(value, &(opts->general.animations))) {
                 return 1;
             }
+        } else if (strcmp(key, "animation_fps") == 0) {
+            /* Clamp to 1 - 60 frames per second */
+            opts->general.animation_fps = (uint8_t)LV_MAX(LV_MIN(strtoul(value, (char **)NULL, 10), 60), 1);
+            return 1;
+        } else if (strcmp(key, "history_chart") == 0) {
+            if (parse_bool(value, &(opts->general.history_chart))) {
+                return 1;
+            }
         } else if (strcmp(key, "backend") == 0) {
             backends_backend_id_t id = backends_find_backend_with_name(value);
             if (id != BACKENDS_BACKEND_NONE) {
@@ -101,6 +138,75 @@ static int parsing_handler(void* user_data, const char* section, const char* key
             /* Use a max ceiling of 60 minutes (3600 secs) */
             opts->general.timeout = (uint16_t)LV_MIN(strtoul(value, (char **)NULL, 10), 3600);
             return 1;
+        } else if (strcmp(key, "full_action") == 0) {
+            if (power_policy_find_full_action(value, &(opts->general.full_action))) {
+                return 1;
+            }
+        } else if (strcmp(key, "display_timeout") == 0) {
+            /* Use a max ceiling of 60 minutes (3600 secs) */
+            opts->general.display_timeout = (uint16_t)LV_MIN(strtoul(value, (char **)NULL, 10), 3600);
+            return 1;
+        } else if (strcmp(key, "long_press_command") == 0) {
+            /* Only absolute paths, the command is executed without a shell */
+            if (value[0] == '/') {
+                free((char *)opts->general.long_press_command);
+                opts->general.long_press_command = strdup(value);
+                return 1;
+            }
+        } else if (strcmp(key, "pixel_shift_interval") == 0) {
+            /* Use a max ceiling of 60 minutes (3600 secs) */
+            opts->general.pixel_shift_interval = (uint16_t)LV_MIN(strtoul(value, (char **)NULL, 10), 3600);
+            return 1;
+        } else if (strcmp(key, "clock_format") == 0) {
+            free((char *)opts->general.clock_format);
+            opts->general.clock_format = value[0] != '\0' ? strdup(value) : NULL;
+            return 1;
+        }
+    } else if (strcmp(section, "backlight") == 0) {
+        if (strcmp(key, "brightness") == 0) {
+            opts->backlight.brightness = parse_pct(value);
+            return 1;
+        } else if (strcmp(key, "dim_timeout") == 0) {
+            /* Use a max ceiling of 60 minutes (3600 secs) */
+            opts->backlight.dim_timeout = (uint16_t)LV_MIN(strtoul(value, (char **)NULL, 10), 3600);
+            return 1;
+        } else if (strcmp(key, "dim_brightness") == 0) {
+            opts->backlight.dim_brightness = parse_pct(value);
+            return 1;
+        } else if (strcmp(key, "low_battery_threshold") == 0) {
+            opts->backlight.low_battery_threshold = parse_pct(value);
+            return 1;
+        } else if (strcmp(key, "low_battery_brightness") == 0) {
+            opts->backlight.low_battery_brightness = parse_pct(value);
+            return 1;
+        } else if (strcmp(key, "full_brightness") == 0) {
+            opts->backlight.full_brightness = parse_pct(value);
+            return 1;
+        }
+    } else if (strcmp(section, "refresh") == 0) {
+        if (strcmp(key, "rate") == 0) {
+            opts->refresh.rate = (uint8_t)LV_MIN(strtoul(value, (char **)NULL, 10), 240);
+            return 1;
+        } else if (strcmp(key, "low_rate") == 0) {
+            opts->refresh.low_rate = (uint8_t)LV_MIN(strtoul(value, (char **)NULL, 10), 240);
+            return 1;
+        } else if (strcmp(key, "hot_temperature") == 0) {
+            opts->refresh.hot_temperature = (uint8_t)LV_MIN(strtoul(value, (char **)NULL, 10), 100);
+            return 1;
+        }
+    } else if (strcmp(section, "sampling") == 0) {
+        if (strcmp(key, "online_min_interval") == 0) {
+            opts->sampling.online_min_interval = (uint32_t)LV_CLAMP(10, strtoul(value, (char **)NULL, 10), 60000);
+            return 1;
+        } else if (strcmp(key, "online_max_interval") == 0) {
+            opts->sampling.online_max_interval = (uint32_t)LV_CLAMP(10, strtoul(value, (char **)NULL, 10), 60000);
+            return 1;
+        } else if (strcmp(key, "battery_min_interval") == 0) {
+            opts->sampling.battery_min_interval = (uint32_t)LV_CLAMP(10, strtoul(value, (char **)NULL, 10), 60000);
+            return 1;
+        } else if (strcmp(key, "battery_max_interval") == 0) {
+            opts->sampling.battery_max_interval = (uint32_t)LV_CLAMP(10, strtoul(value, (char **)NULL, 10), 60000);
+            return 1;
         }
     } else if (strcmp(section, "theme") == 0) {
         if (strcmp(key, "default") == 0) {
@@ -122,6 +228,10 @@ static int parsing_handler(void* user_data, const char* section, const char* key
     return 1; /* Return 1 (true) so that we can use the return value of ini_parse exclusively for file-level errors (e.g. file not found) */
 }
 
+static uint8_t parse_pct(const char *value) {
+    return (uint8_t)LV_MIN(strtoul(value, (char **)NULL, 10), 100);
+}
+
 static bool parse_bool(const char *value, bool *result) {
     if (strcmp(value, "true") == 0) {
         *result = true;
@@ -22,6 +22,10 @@
 #define CONFIG_H
 
 #include "backends.h"
+#include "backlight.h"
+#include "power_policy.h"
+#include "refresh_governor.h"
+#include "sampler.h"
 #include "themes.h"
 
 #include <stdbool.h>
@@ -35,8 +39,22 @@ typedef struct {
     backends_backend_id_t backend;
     /* If true, use animations */
     bool animations;
-    /* Timeout (in seconds) - once elapsed, the device will shutdown. 0 (default) to disable */
+    /* Maximum frame rate of animations */
+    uint8_t animation_fps;
+    /* If true, show a chart of the capacity over the session below the battery */
+    bool history_chart;
+    /* Timeout (in seconds) - once elapsed without user input, the device will shutdown. 0 (default) to disable */
     uint16_t timeout;
+    /* Action to take once the battery is full and there was no recent user input */
+    power_policy_full_action_t full_action;
+    /* Idle time (in seconds) after which the display is turned off. 0 (default) to disable */
+    uint16_t display_timeout;
+    /* Command to execute when the power key is held, NULL (default) to reboot */
+    const char *long_press_command;
+    /* Time (in seconds) between two shifts of the image against burn-in. 0 (default) to disable */
+    uint16_t pixel_shift_interval;
+    /* strftime format of the clock with at most minute resolution, NULL (default) to hide the clock */
+    const char *clock_format;
 } config_opts_general;
 
 /**
@@ -57,6 +75,12 @@ typedef struct {
     config_opts_general general;
     /* Options related to the theme */
     config_opts_theme theme;
+    /* Brightness policy */
+    backlight_policy backlight;
+    /* Refresh rate policy */
+    refresh_governor_policy refresh;
+    /* Sampling intervals of the polling fallback */
+    sampler_policy sampling;
 } config_opts;
 
 /**
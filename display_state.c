@@ -0,0 +1,245 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "display_state.h"
+
+#include "backlight.h"
+#include "event_loop.h"
+#include "trace.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <linux/fb.h>
+
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/timerfd.h>
+
+
+/**
+ * Static variables
+ */
+
+static const char *state_names[DISPLAY_STATE_COUNT] = { "on", "off", "away" };
+
+static backends_backend_id_t backend_id = BACKENDS_BACKEND_NONE;
+static uint16_t idle_timeout_s = 0;
+static int timer_fd = -1;
+
+static display_state_t state = DISPLAY_STATE_ON;
+static int64_t state_since_us = 0;
+static int64_t time_in_state_us[DISPLAY_STATE_COUNT] = { 0 };
+static uint32_t num_transitions = 0;
+
+static display_state_change_cb_t change_cb = NULL;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Restart the idle timer.
+ */
+static void arm_idle_timer(void);
+
+/**
+ * Handle expiry of the idle timer.
+ *
+ * @param fd timer file descriptor
+ * @param events is unused
+ * @param user_data is unused
+ */
+static void handle_idle_timer(int fd, uint32_t events, void *user_data);
+
+/**
+ * Blank or unblank the framebuffer if the fbdev backend is in use.
+ *
+ * @param is_blank true to power the panel down, false to power it up
+ */
+static void blank_framebuffer(bool is_blank);
+
+/**
+ * Switch to a new state and account the time spent in the previous one.
+ *
+ * @param new_state state to switch to
+ */
+static void set_state(display_state_t new_state);
+
+
+/**
+ * Static functions
+ */
+
+static void arm_idle_timer(void) {
+    if (timer_fd < 0) {
+        return;
+    }
+
+    struct itimerspec spec = { .it_value = { .tv_sec = idle_timeout_s } };
+    timerfd_settime(timer_fd, 0, &spec, NULL);
+}
+
+static void handle_idle_timer(int fd, uint32_t events, void *user_data) {
+    (void)events;
+    (void)user_data;
+
+    uint64_t expirations;
+    if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations) || state != DISPLAY_STATE_ON) {
+        return;
+    }
+
+    set_state(DISPLAY_STATE_OFF);
+}
+
+static void blank_framebuffer(bool is_blank) {
+#if USE_FBDEV
+    if (backend_id != BACKENDS_BACKEND_FBDEV) {
+        return;
+    }
+
+    int fd = open(FBDEV_PATH, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    if (ioctl(fd, FBIOBLANK, is_blank ? FB_BLANK_POWERDOWN : FB_BLANK_UNBLANK) != 0) {
+        perror("Failed to change framebuffer blanking");
+    }
+    close(fd);
+#else
+    (void)is_blank;
+#endif /* USE_FBDEV */
+}
+
+static void set_state(display_state_t new_state) {
+    if (new_state == state) {
+        return;
+    }
+
+    if (state == DISPLAY_STATE_OFF) {
+        blank_framebuffer(false);
+    }
+
+    if (new_state == DISPLAY_STATE_OFF) {
+        backlight_set_enabled(false);
+        blank_framebuffer(true);
+    } else if (new_state == DISPLAY_STATE_ON) {
+        backlight_set_enabled(true);
+        arm_idle_timer();
+    }
+
+    int64_t now_us = trace_now_us();
+    int64_t elapsed_us = now_us - state_since_us;
+    time_in_state_us[state] += elapsed_us;
+
+    printf("Display %s after %lld.%01llds %s\n", state_names[new_state], (long long)(elapsed_us / 1000000),
+        (long long)((elapsed_us % 1000000) / 100000), state_names[state]);
+
+    state = new_state;
+    state_since_us = now_us;
+    ++num_transitions;
+
+    display_state_log_stats();
+
+    if (change_cb) {
+        change_cb(state);
+    }
+}
+
+
+/**
+ * Public functions
+ */
+
+void display_state_init(backends_backend_id_t backend, uint16_t idle_timeout) {
+    backend_id = backend;
+    idle_timeout_s = idle_timeout;
+    state = DISPLAY_STATE_ON;
+    state_since_us = trace_now_us();
+
+    if (idle_timeout_s == 0) {
+        return;
+    }
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd < 0) {
+        perror("Failed to create idle timer");
+        return;
+    }
+
+    if (!event_loop_add_fd(timer_fd, EPOLLIN, handle_idle_timer, NULL)) {
+        close(timer_fd);
+        timer_fd = -1;
+        return;
+    }
+
+    arm_idle_timer();
+}
+
+void display_state_set_change_cb(display_state_change_cb_t cb) {
+    change_cb = cb;
+}
+
+bool display_state_is_on(void) {
+    return state == DISPLAY_STATE_ON;
+}
+
+void display_state_activity(void) {
+    if (state == DISPLAY_STATE_ON) {
+        arm_idle_timer();
+        backlight_activity();
+    } else if (state == DISPLAY_STATE_OFF) {
+        set_state(DISPLAY_STATE_ON);
+    }
+}
+
+void display_state_toggle(void) {
+    if (state != DISPLAY_STATE_AWAY) {
+        set_state(state == DISPLAY_STATE_ON ? DISPLAY_STATE_OFF : DISPLAY_STATE_ON);
+    }
+}
+
+void display_state_set_away(bool is_away) {
+    if (is_away) {
+        set_state(DISPLAY_STATE_AWAY);
+    } else if (state == DISPLAY_STATE_AWAY) {
+        set_state(DISPLAY_STATE_ON);
+    }
+}
+
+void display_state_restore(void) {
+    if (state == DISPLAY_STATE_OFF) {
+        blank_framebuffer(false);
+    }
+}
+
+void display_state_log_stats(void) {
+    int64_t current_us = trace_now_us() - state_since_us;
+
+    printf("Display states (%u transitions):", num_transitions);
+    for (int i = 0; i < DISPLAY_STATE_COUNT; ++i) {
+        int64_t total_us = time_in_state_us[i] + (i == (int)state ? current_us : 0);
+        printf(" %s=%llds", state_names[i], (long long)(total_us / 1000000));
+    }
+    printf("\n");
+}
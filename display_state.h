@@ -0,0 +1,99 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DISPLAY_STATE_H
+#define DISPLAY_STATE_H
+
+#include "backends.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Display power states
+ */
+typedef enum {
+    DISPLAY_STATE_ON,
+    DISPLAY_STATE_OFF,
+    /* Another VT owns the display */
+    DISPLAY_STATE_AWAY,
+    DISPLAY_STATE_COUNT
+} display_state_t;
+
+/**
+ * Callback for display state changes
+ *
+ * @param state new state
+ */
+typedef void (*display_state_change_cb_t)(display_state_t state);
+
+/**
+ * Start tracking the display state and arm the idle timer on the event loop. Requires
+ * event_loop_init to have been called.
+ *
+ * @param backend display backend in use (fbdev is additionally blanked with FBIOBLANK)
+ * @param idle_timeout seconds without activity after which the display is turned off, 0 to disable
+ */
+void display_state_init(backends_backend_id_t backend, uint16_t idle_timeout);
+
+/**
+ * Set a callback for display state changes.
+ *
+ * @param cb callback, called after the state has changed
+ */
+void display_state_set_change_cb(display_state_change_cb_t cb);
+
+/**
+ * Check whether the display is on. While it is off, LVGL must not be run.
+ *
+ * @return true if the display is on, false otherwise
+ */
+bool display_state_is_on(void);
+
+/**
+ * Record user or charger activity. Turns the display on if necessary and restarts the idle timer.
+ * Has no effect while another VT owns the display.
+ */
+void display_state_activity(void);
+
+/**
+ * Turn the display off if it is on and vice versa. Has no effect while another VT owns the display.
+ */
+void display_state_toggle(void);
+
+/**
+ * Hand the display to another VT or take it back. The panel is left on for the other VT and the
+ * display is turned on when it comes back.
+ *
+ * @param is_away true if another VT is about to take over, false if the display was reacquired
+ */
+void display_state_set_away(bool is_away);
+
+/**
+ * Unblank the panel if the display is off, without changing the state. Used on teardown.
+ */
+void display_state_restore(void);
+
+/**
+ * Print the time spent in each state so far.
+ */
+void display_state_log_stats(void);
+
+#endif /* DISPLAY_STATE_H */
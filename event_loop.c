@@ -0,0 +1,142 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "event_loop.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+
+
+/**
+ * Static variables
+ */
+
+/* A watched file descriptor */
+typedef struct {
+    int fd;
+    event_loop_cb_t cb;
+    void *user_data;
+    /* Incremented whenever the slot is reused, so that events queued for a previous source are dropped */
+    uint32_t generation;
+} event_source;
+
+static int epoll_fd = -1;
+static event_source sources[EVENT_LOOP_MAX_SOURCES];
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Find the source slot of a file descriptor.
+ *
+ * @param fd file descriptor to look up or -1 to find a free slot
+ * @return pointer to the slot or NULL if there is none
+ */
+static event_source *find_source(int fd);
+
+
+/**
+ * Static functions
+ */
+
+static event_source *find_source(int fd) {
+    for (int i = 0; i < EVENT_LOOP_MAX_SOURCES; ++i) {
+        if (sources[i].fd == fd) {
+            return &(sources[i]);
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * Public functions
+ */
+
+void event_loop_init(void) {
+    for (int i = 0; i < EVENT_LOOP_MAX_SOURCES; ++i) {
+        sources[i].fd = -1;
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        perror("Failed to create epoll instance");
+        exit(EXIT_FAILURE);
+    }
+}
+
+bool event_loop_add_fd(int fd, uint32_t events, event_loop_cb_t cb, void *user_data) {
+    event_source *source = find_source(-1);
+    if (fd < 0 || source == NULL) {
+        printf("Cannot watch file descriptor %d\n", fd);
+        return false;
+    }
+
+    /* The epoll data carries the slot index in the low and the slot's generation in the high half */
+    uint32_t generation = source->generation + 1;
+    struct epoll_event event = { .events = events,
+        .data.u64 = (uint64_t)generation << 32 | (uint32_t)(source - sources) };
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        perror("Failed to watch file descriptor");
+        return false;
+    }
+
+    source->fd = fd;
+    source->cb = cb;
+    source->user_data = user_data;
+    source->generation = generation;
+    return true;
+}
+
+void event_loop_remove_fd(int fd) {
+    event_source *source = find_source(fd);
+    if (fd < 0 || source == NULL) {
+        return;
+    }
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    source->fd = -1;
+}
+
+void event_loop_run_once(int timeout_ms) {
+    struct epoll_event events[EVENT_LOOP_MAX_SOURCES];
+
+    int count = epoll_wait(epoll_fd, events, EVENT_LOOP_MAX_SOURCES, timeout_ms);
+    if (count < 0) {
+        if (errno != EINTR) {
+            perror("Failed to wait for events");
+        }
+        return;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        event_source *source = &(sources[(uint32_t)events[i].data.u64]);
+        /* Skip sources that an earlier callback in this batch removed or replaced */
+        if (source->fd >= 0 && source->generation == (uint32_t)(events[i].data.u64 >> 32)) {
+            source->cb(source->fd, events[i].events, source->user_data);
+        }
+    }
+}
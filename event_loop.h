@@ -0,0 +1,64 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Maximum number of file descriptors that can be watched at once */
+#define EVENT_LOOP_MAX_SOURCES 48
+
+/* Callback for a file descriptor that became ready */
+typedef void (*event_loop_cb_t)(int fd, uint32_t events, void *user_data);
+
+/**
+ * Create the epoll instance. Exits on failure.
+ */
+void event_loop_init(void);
+
+/**
+ * Watch a file descriptor.
+ *
+ * @param fd file descriptor to watch
+ * @param events epoll event mask (e.g. EPOLLIN)
+ * @param cb callback to invoke when the file descriptor is ready
+ * @param user_data pointer passed to the callback
+ * @return true on success, false otherwise
+ */
+bool event_loop_add_fd(int fd, uint32_t events, event_loop_cb_t cb, void *user_data);
+
+/**
+ * Stop watching a file descriptor. Safe to call from within a callback, events of the same batch
+ * that are still pending for the file descriptor are dropped even if its slot is reused.
+ *
+ * @param fd file descriptor to remove
+ */
+void event_loop_remove_fd(int fd);
+
+/**
+ * Wait for events and dispatch them to their callbacks.
+ *
+ * @param timeout_ms maximum time to block in milliseconds or -1 to block until an event arrives
+ */
+void event_loop_run_once(int timeout_ms);
+
+#endif /* EVENT_LOOP_H */
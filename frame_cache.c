@@ -0,0 +1,119 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "frame_cache.h"
+
+#include "trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Static variables
+ */
+
+static lv_disp_t *cached_disp = NULL;
+static void (*original_flush_cb)(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) = NULL;
+
+/* Full frame in display coordinates, i.e. without the driver's offset. Kept outside of LVGL's heap
+ * because it is much larger than everything else. */
+static lv_color_t *frame = NULL;
+static lv_coord_t frame_width = 0;
+static lv_coord_t frame_height = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Copy a flushed area into the cache and forward it to the display driver.
+ *
+ * @param disp_drv display driver
+ * @param area area to flush
+ * @param color_p pixels to flush
+ */
+static void caching_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+
+
+/**
+ * Static functions
+ */
+
+static void caching_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
+    /* LVGL adds the driver's offset before flushing, the offset changes when the image is shifted */
+    lv_area_t frame_area = *area;
+    lv_area_move(&frame_area, -disp_drv->offset_x, -disp_drv->offset_y);
+
+    lv_coord_t width = lv_area_get_width(area);
+    lv_coord_t x1 = LV_MAX(frame_area.x1, 0);
+    lv_coord_t x2 = LV_MIN(frame_area.x2, frame_width - 1);
+
+    if (x1 <= x2) {
+        for (lv_coord_t y = LV_MAX(frame_area.y1, 0); y <= LV_MIN(frame_area.y2, frame_height - 1); ++y) {
+            memcpy(&(frame[(size_t)y * frame_width + x1]),
+                &(color_p[(size_t)(y - frame_area.y1) * width + (x1 - frame_area.x1)]),
+                (size_t)(x2 - x1 + 1) * sizeof(lv_color_t));
+        }
+    }
+
+    original_flush_cb(disp_drv, area, color_p);
+}
+
+
+/**
+ * Public functions
+ */
+
+bool frame_cache_init(lv_disp_t *disp) {
+    frame_width = lv_disp_get_hor_res(disp);
+    frame_height = lv_disp_get_ver_res(disp);
+
+    frame = calloc((size_t)frame_width * frame_height, sizeof(lv_color_t));
+    if (frame == NULL) {
+        printf("Failed to allocate frame cache\n");
+        return false;
+    }
+
+    cached_disp = disp;
+    original_flush_cb = disp->driver->flush_cb;
+    disp->driver->flush_cb = caching_flush_cb;
+    return true;
+}
+
+void frame_cache_restore(void) {
+    if (frame == NULL) {
+        return;
+    }
+
+    int64_t start_us = trace_now_us();
+
+    /* Bypass the cache, the drivers signal readiness themselves which is harmless outside a refresh.
+     * The frame goes where LVGL would flush it now, at the current offset. */
+    lv_disp_drv_t *drv = cached_disp->driver;
+    lv_area_t area = { 0, 0, frame_width - 1, frame_height - 1 };
+    lv_area_move(&area, drv->offset_x, drv->offset_y);
+    original_flush_cb(cached_disp->driver, &area, frame);
+
+    int64_t duration_us = trace_now_us() - start_us;
+    printf("Restored cached frame in %lld.%01lldms\n", (long long)(duration_us / 1000), (long long)((duration_us % 1000) / 100));
+}
@@ -0,0 +1,45 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+
+/**
+ * Keep a copy of everything flushed to a display so that the screen can be restored without
+ * rendering. Wraps the display's flush callback and must be called before the first frame is
+ * flushed and after the display's size is final, e.g. after pixel_shift_init. The frame is kept in
+ * display coordinates and restored at the driver's current offset. Wrappers installed earlier
+ * also process the restored frame.
+ *
+ * @param disp display to cache
+ * @return true on success, false if the cache could not be allocated
+ */
+bool frame_cache_init(lv_disp_t *disp);
+
+/**
+ * Flush the cached frame to the display in one go.
+ */
+void frame_cache_restore(void);
+
+#endif /* FRAME_CACHE_H */
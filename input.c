@@ -0,0 +1,419 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "input.h"
+
+#include "display_state.h"
+#include "event_loop.h"
+#include "pixel_shift.h"
+#include "trace.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/input.h>
+
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+
+
+/**
+ * Static variables
+ */
+
+#define INPUT_DIR "/dev/input"
+
+#define BITS_PER_LONG (sizeof(unsigned long) * 8)
+#define NUM_LONGS(bits) (((bits) + BITS_PER_LONG - 1) / BITS_PER_LONG)
+
+/* Presses that don't lead to visible pixels within this window are not measured */
+#define LATENCY_WINDOW_US 250000
+
+/* A watched input device */
+typedef struct {
+    int fd;
+    bool is_touchscreen;
+    bool is_multitouch;
+    bool has_tracking_id;
+    struct input_absinfo abs_x;
+    struct input_absinfo abs_y;
+} input_device;
+
+static input_device devices[INPUT_MAX_DEVICES];
+static int num_devices = 0;
+
+static input_key_cb_t key_cb = NULL;
+
+static lv_disp_t *touch_disp = NULL;
+static lv_indev_t *touch_indev = NULL;
+/* Touch state committed on SYN_REPORT, in raw device coordinates */
+static int32_t touch_x = 0;
+static int32_t touch_y = 0;
+static bool is_touch_pressed = false;
+/* Touch state accumulated since the last SYN_REPORT */
+static int32_t pending_x = 0;
+static int32_t pending_y = 0;
+static bool is_pending_pressed = false;
+static int32_t current_slot = 0;
+/* Whether a type A device already reported its first contact since the last SYN_REPORT */
+static bool is_first_contact_reported = false;
+
+/* Kernel timestamp of the press that still awaits visible pixels, -1 if there is none */
+static int64_t pending_press_us = -1;
+static uint32_t num_latency_samples = 0;
+static int64_t latency_sum_us = 0;
+static int64_t latency_min_us = 0;
+static int64_t latency_max_us = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Check whether a bit is set in a capability bitmask.
+ *
+ * @param bits bitmask as returned by EVIOCGBIT
+ * @param bit bit to test
+ * @return true if the bit is set, false otherwise
+ */
+static bool test_bit(const unsigned long *bits, unsigned int bit);
+
+/**
+ * Determine the capabilities of an input device.
+ *
+ * @param device device with an open file descriptor, the capability fields are filled in
+ * @return true if the device has any of the keys or is a touchscreen, false otherwise
+ */
+static bool probe_device(input_device *device);
+
+/**
+ * Get the kernel timestamp of an input event.
+ *
+ * @param event input event
+ * @return microseconds since boot
+ */
+static int64_t get_event_time_us(const struct input_event *event);
+
+/**
+ * Handle an event from a touchscreen.
+ *
+ * @param device device that reported the event
+ * @param event input event
+ */
+static void handle_touch_event(input_device *device, const struct input_event *event);
+
+/**
+ * Read and dispatch pending events of an input device.
+ *
+ * @param fd input device
+ * @param events epoll event mask
+ * @param user_data the input_device
+ */
+static void handle_input(int fd, uint32_t events, void *user_data);
+
+/**
+ * Forget the pending press if handling it left nothing to redraw, so that an unrelated flush
+ * doesn't complete its latency measurement.
+ */
+static void drop_press_without_redraw(void);
+
+/**
+ * Scale a raw touch coordinate to the panel.
+ *
+ * @param value raw coordinate
+ * @param info range of the axis
+ * @param start display coordinate of the panel's first pixel along the axis
+ * @param resolution panel resolution along the axis
+ * @return display coordinate
+ */
+static lv_coord_t scale_coordinate(int32_t value, const struct input_absinfo *info, lv_coord_t start,
+    lv_coord_t resolution);
+
+/**
+ * Report the touch state to LVGL.
+ *
+ * @param indev_drv input device driver
+ * @param data pointer for writing the state into
+ */
+static void touch_read_cb(lv_indev_drv_t *indev_drv, lv_indev_data_t *data);
+
+
+/**
+ * Static functions
+ */
+
+static bool test_bit(const unsigned long *bits, unsigned int bit) {
+    return (bits[bit / BITS_PER_LONG] >> (bit % BITS_PER_LONG)) & 1UL;
+}
+
+static bool probe_device(input_device *device) {
+    unsigned long ev_bits[NUM_LONGS(EV_CNT)] = { 0 };
+    unsigned long key_bits[NUM_LONGS(KEY_CNT)] = { 0 };
+    unsigned long abs_bits[NUM_LONGS(ABS_CNT)] = { 0 };
+    unsigned long prop_bits[NUM_LONGS(INPUT_PROP_CNT)] = { 0 };
+
+    if (ioctl(device->fd, EVIOCGBIT(0, sizeof(ev_bits)), ev_bits) < 0 || !test_bit(ev_bits, EV_KEY)) {
+        return false;
+    }
+    ioctl(device->fd, EVIOCGBIT(EV_KEY, sizeof(key_bits)), key_bits);
+    ioctl(device->fd, EVIOCGPROP(sizeof(prop_bits)), prop_bits);
+    if (test_bit(ev_bits, EV_ABS)) {
+        ioctl(device->fd, EVIOCGBIT(EV_ABS, sizeof(abs_bits)), abs_bits);
+    }
+
+    bool has_keys = test_bit(key_bits, KEY_POWER) || test_bit(key_bits, KEY_VOLUMEUP)
+        || test_bit(key_bits, KEY_VOLUMEDOWN);
+
+    /* Touchpads report the same axes, only direct input devices map onto the display */
+    device->is_multitouch = test_bit(abs_bits, ABS_MT_POSITION_X) && test_bit(abs_bits, ABS_MT_POSITION_Y);
+    device->has_tracking_id = device->is_multitouch && test_bit(abs_bits, ABS_MT_TRACKING_ID);
+    bool has_axes = device->is_multitouch || (test_bit(abs_bits, ABS_X) && test_bit(abs_bits, ABS_Y));
+    device->is_touchscreen = has_axes && test_bit(key_bits, BTN_TOUCH)
+        && (test_bit(prop_bits, INPUT_PROP_DIRECT) || device->is_multitouch);
+
+    if (device->is_touchscreen) {
+        int axis_x = device->is_multitouch ? ABS_MT_POSITION_X : ABS_X;
+        int axis_y = device->is_multitouch ? ABS_MT_POSITION_Y : ABS_Y;
+        if (ioctl(device->fd, EVIOCGABS(axis_x), &(device->abs_x)) < 0
+            || ioctl(device->fd, EVIOCGABS(axis_y), &(device->abs_y)) < 0) {
+            device->is_touchscreen = false;
+        }
+    }
+
+    return has_keys || device->is_touchscreen;
+}
+
+static int64_t get_event_time_us(const struct input_event *event) {
+    return (int64_t)event->input_event_sec * 1000000 + event->input_event_usec;
+}
+
+static void handle_touch_event(input_device *device, const struct input_event *event) {
+    switch (event->type) {
+    case EV_ABS:
+        if (event->code == ABS_MT_SLOT) {
+            current_slot = event->value;
+        } else if (current_slot != 0 || is_first_contact_reported) {
+            /* Only the first finger is tracked */
+        } else if (event->code == ABS_MT_TRACKING_ID) {
+            is_pending_pressed = event->value >= 0;
+        } else if (event->code == (device->is_multitouch ? ABS_MT_POSITION_X : ABS_X)) {
+            pending_x = event->value;
+        } else if (event->code == (device->is_multitouch ? ABS_MT_POSITION_Y : ABS_Y)) {
+            pending_y = event->value;
+        }
+        break;
+    case EV_KEY:
+        /* Type A devices and some type B ones don't report tracking IDs, only BTN_TOUCH */
+        if (event->code == BTN_TOUCH && !device->has_tracking_id) {
+            is_pending_pressed = event->value != 0;
+        }
+        break;
+    case EV_SYN:
+        if (event->code == SYN_MT_REPORT) {
+            is_first_contact_reported = true;
+        }
+        if (event->code != SYN_REPORT) {
+            break;
+        }
+
+        is_first_contact_reported = false;
+
+        bool is_new_press = is_pending_pressed && !is_touch_pressed;
+        touch_x = pending_x;
+        touch_y = pending_y;
+        is_touch_pressed = is_pending_pressed;
+
+        /* Touches don't wake the display, they only keep it on */
+        if (!display_state_is_on()) {
+            break;
+        }
+        display_state_activity();
+
+        if (is_new_press) {
+            pending_press_us = get_event_time_us(event);
+            key_cb(BTN_TOUCH, 1, pending_press_us);
+        }
+
+        /* The read timer is paused, read the new state right away */
+        if (touch_indev) {
+            lv_indev_read_timer_cb(touch_indev->driver->read_timer);
+        }
+        drop_press_without_redraw();
+        break;
+    default:
+        break;
+    }
+}
+
+static void handle_input(int fd, uint32_t events, void *user_data) {
+    input_device *device = (input_device *)user_data;
+
+    if (events & (EPOLLHUP | EPOLLERR)) {
+        event_loop_remove_fd(fd);
+        close(fd);
+        device->fd = -1;
+        return;
+    }
+
+    struct input_event buffer[32];
+    ssize_t len;
+    while ((len = read(fd, buffer, sizeof(buffer))) > 0) {
+        for (size_t i = 0; i < (size_t)len / sizeof(buffer[0]); ++i) {
+            const struct input_event *event = &(buffer[i]);
+
+            if (device->is_touchscreen) {
+                handle_touch_event(device, event);
+            } else if (event->type == EV_KEY) {
+                int64_t time_us = get_event_time_us(event);
+                if (event->value == 1) {
+                    pending_press_us = time_us;
+                }
+                key_cb(event->code, event->value, time_us);
+                drop_press_without_redraw();
+            }
+        }
+    }
+}
+
+static void drop_press_without_redraw(void) {
+    if (touch_disp && touch_disp->inv_p == 0) {
+        pending_press_us = -1;
+    }
+}
+
+static lv_coord_t scale_coordinate(int32_t value, const struct input_absinfo *info, lv_coord_t start,
+    lv_coord_t resolution) {
+    int64_t range = (int64_t)info->maximum - info->minimum + 1;
+    if (range <= 0) {
+        return start;
+    }
+    return (lv_coord_t)(start + ((int64_t)value - info->minimum) * resolution / range);
+}
+
+static void touch_read_cb(lv_indev_drv_t *indev_drv, lv_indev_data_t *data) {
+    const input_device *device = (const input_device *)indev_drv->user_data;
+
+    /* The touchscreen spans the panel, which may be larger than the display and moving against it */
+    lv_area_t panel;
+    pixel_shift_get_panel_area(touch_disp, &panel);
+    data->point.x = scale_coordinate(touch_x, &(device->abs_x), panel.x1, lv_area_get_width(&panel));
+    data->point.y = scale_coordinate(touch_y, &(device->abs_y), panel.y1, lv_area_get_height(&panel));
+    data->state = is_touch_pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+}
+
+
+/**
+ * Public functions
+ */
+
+bool input_init(lv_disp_t *disp, input_key_cb_t cb) {
+    key_cb = cb;
+    touch_disp = disp;
+
+    DIR *dir = opendir(INPUT_DIR);
+    if (dir == NULL) {
+        printf("Could not open %s\n", INPUT_DIR);
+        return false;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL && num_devices < INPUT_MAX_DEVICES) {
+        if (strncmp(entry->d_name, "event", 5) != 0) {
+            continue;
+        }
+
+        char path[64];
+        snprintf(path, sizeof(path), "%s/%s", INPUT_DIR, entry->d_name);
+
+        input_device *device = &(devices[num_devices]);
+        memset(device, 0, sizeof(*device));
+        device->fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (device->fd < 0) {
+            continue;
+        }
+
+        if (!probe_device(device) || (device->is_touchscreen && touch_indev)
+            || !event_loop_add_fd(device->fd, EPOLLIN, handle_input, device)) {
+            close(device->fd);
+            continue;
+        }
+
+        /* Timestamp events on the same clock as the startup trace */
+        int clock_id = CLOCK_BOOTTIME;
+        ioctl(device->fd, EVIOCSCLOCKID, &clock_id);
+
+        if (device->is_touchscreen) {
+            static lv_indev_drv_t indev_drv;
+            lv_indev_drv_init(&indev_drv);
+            indev_drv.type = LV_INDEV_TYPE_POINTER;
+            indev_drv.read_cb = touch_read_cb;
+            indev_drv.user_data = device;
+            indev_drv.disp = disp;
+            touch_indev = lv_indev_drv_register(&indev_drv);
+            lv_timer_pause(touch_indev->driver->read_timer);
+        }
+
+        printf("Watching %s as %s\n", path, device->is_touchscreen ? "touchscreen" : "keys");
+        ++num_devices;
+    }
+    closedir(dir);
+
+    return num_devices > 0;
+}
+
+void input_mark_pixels_visible(void) {
+    if (pending_press_us < 0) {
+        return;
+    }
+
+    int64_t latency_us = trace_now_us() - pending_press_us;
+    pending_press_us = -1;
+    if (latency_us < 0 || latency_us > LATENCY_WINDOW_US) {
+        return;
+    }
+
+    if (num_latency_samples == 0 || latency_us < latency_min_us) {
+        latency_min_us = latency_us;
+    }
+    if (latency_us > latency_max_us) {
+        latency_max_us = latency_us;
+    }
+    latency_sum_us += latency_us;
+    ++num_latency_samples;
+
+    printf("Input to pixel: %lld.%01lldms\n", (long long)(latency_us / 1000), (long long)((latency_us % 1000) / 100));
+}
+
+void input_log_stats(void) {
+    if (num_latency_samples == 0) {
+        printf("Input to pixel: no samples\n");
+        return;
+    }
+
+    printf("Input to pixel (%u samples): min=%lld.%01lldms avg=%lld.%01lldms max=%lld.%01lldms\n", num_latency_samples,
+        (long long)(latency_min_us / 1000), (long long)((latency_min_us % 1000) / 100),
+        (long long)(latency_sum_us / num_latency_samples / 1000), (long long)((latency_sum_us / num_latency_samples % 1000) / 100),
+        (long long)(latency_max_us / 1000), (long long)((latency_max_us % 1000) / 100));
+}
@@ -0,0 +1,60 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Maximum number of input devices that are watched */
+#define INPUT_MAX_DEVICES 8
+
+/* Callback for a key event, value is 1 for press, 0 for release and 2 for autorepeat, time_us is the
+   kernel timestamp of the event in microseconds since boot. Touch presses are reported as BTN_TOUCH
+   while the display is on. */
+typedef void (*input_key_cb_t)(uint16_t code, int32_t value, int64_t time_us);
+
+/**
+ * Find the power and volume keys and the touchscreen by their capabilities and watch them on the
+ * event loop. Touches are fed to LVGL as they arrive instead of being polled. Requires
+ * event_loop_init and display_state_init to have been called.
+ *
+ * @param disp display that touch coordinates are scaled to
+ * @param cb callback to invoke for key events
+ * @return true if at least one device was found, false otherwise
+ */
+bool input_init(lv_disp_t *disp, input_key_cb_t cb);
+
+/**
+ * Record that the result of the most recent press is visible, either because a frame was flushed
+ * or because the display was turned on. Completes an input-to-pixel latency measurement. Presses
+ * that left nothing to redraw are not measured.
+ */
+void input_mark_pixels_visible(void);
+
+/**
+ * Print input-to-pixel latency statistics.
+ */
+void input_log_stats(void);
+
+#endif /* INPUT_H */
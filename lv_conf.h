@@ -49,19 +49,28 @@
    MEMORY SETTINGS
  *=========================*/
 
+/*Size of LVGL's memory pool (or the init-time arena of the arena allocator) in kilobytes, injected by meson*/
+#ifndef LV_MEM_SIZE_KB
+#  define LV_MEM_SIZE_KB 128U
+#endif
+
 /*1: use custom malloc/free, 0: use the built-in `lv_mem_alloc()` and `lv_mem_free()`*/
+#if USE_CUSTOM_ALLOCATOR
+#define LV_MEM_CUSTOM      1
+#else
 #define LV_MEM_CUSTOM      0
+#endif
 #if LV_MEM_CUSTOM == 0
 /*Size of the memory available for `lv_mem_alloc()` in bytes (>= 2kB)*/
-#  define LV_MEM_SIZE    (128U * 1024U)          /*[bytes]*/
+#  define LV_MEM_SIZE    (LV_MEM_SIZE_KB * 1024U)          /*[bytes]*/
 
 /*Set an address for the memory pool instead of allocating it as a normal array. Can be in external SRAM too.*/
 #  define LV_MEM_ADR          0     /*0: unused*/
 #else       /*LV_MEM_CUSTOM*/
-#  define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /*Header for the dynamic memory function*/
-#  define LV_MEM_CUSTOM_ALLOC     malloc
-#  define LV_MEM_CUSTOM_FREE      free
-#  define LV_MEM_CUSTOM_REALLOC   realloc
+#  define LV_MEM_CUSTOM_INCLUDE "allocator.h"   /*Header for the dynamic memory function*/
+#  define LV_MEM_CUSTOM_ALLOC     allocator_alloc
+#  define LV_MEM_CUSTOM_FREE      allocator_free
+#  define LV_MEM_CUSTOM_REALLOC   allocator_realloc
 #endif     /*LV_MEM_CUSTOM*/
 
 /*Use the standard `memcpy` and `memset` instead of LVGL's own functions. (Might or might not be faster).*/
@@ -20,35 +20,45 @@
  */
 
 
+#include "allocator.h"
 #include "backends.h"
+#include "backlight.h"
+#include "charge_animation.h"
+#include "charger_ui.h"
 #include "command_line.h"
+#include "display_state.h"
+#include "event_loop.h"
+#include "frame_cache.h"
+#include "input.h"
 #include "lvglcharger.h"
+#include "pixel_shift.h"
+#include "power_key.h"
+#include "power_policy.h"
+#include "power_supply.h"
+#include "refresh_governor.h"
+#include "sampler.h"
+#include "shutdown.h"
+#include "soft_dim.h"
+#include "splash.h"
+#include "startup.h"
+#include "steady_state.h"
 #include "terminal.h"
 #include "theme.h"
+#include "trace.h"
 #include "themes.h"
+#include "uevent.h"
 #include "config.h"
 
-#include "lv_drv_conf.h"
-
-#if USE_FBDEV
-#include "lv_drivers/display/fbdev.h"
-#endif /* USE_FBDEV */
-#if USE_DRM
-#include "lv_drivers/display/drm.h"
-#endif /* USE_DRM */
-#if USE_MINUI
-#include "lv_drivers/display/minui.h"
-#endif /* USE_MINUI */
-
 #include "lvgl/lvgl.h"
 
-#include <signal.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <stdio.h>
-#include <pthread.h>
+#include <string.h>
+
+#include <linux/input.h>
 
-#include <sys/reboot.h>
 #include <sys/time.h>
 
 /**
@@ -57,18 +67,14 @@
 
 #define CMDLINE_FILE "/proc/cmdline"
 #define CHARGER_STRING "androidboot.bootreason=usb"
-#define BATTERY_CAPACITY "/sys/class/power_supply/battery/capacity"
-#define CHARGER_ONLINE "/sys/class/power_supply/charger/online"
-#define MAX_BRIGHTNESS_PATH "/sys/class/leds/lcd-backlight/max_brightness"
-#define BRIGHTNESS_PATH "/sys/class/leds/lcd-backlight/brightness"
 
 cli_opts cli_options;
 config_opts conf_opts;
 
-bool is_alternate_theme = true;
+bool is_alternate_theme = false;
 
-lv_obj_t *battery_fill;
-lv_obj_t *battery_label;
+static int64_t first_flush_time_us = -1;
+static char battery_status[16];
 
 /**
  * Static prototypes
@@ -77,16 +83,45 @@ lv_obj_t *battery_label;
 /**
  * Set the UI theme.
  *
- * @param is_dark true if the dark theme should be applied, false if the light theme should be applied
+ * @param is_alternate true if the alternate theme should be applied, false if the default theme should be applied
+ */
+static void set_theme(bool is_alternate);
+
+/**
+ * Print live statistics of all subsystems.
+ */
+static void log_stats(void);
+
+/**
+ * Restore the backlight to its value from before startup.
+ */
+static void restore_backlight(void);
+
+/**
+ * Move the scanout back to its original position and release the display backend.
+ */
+static void release_display(void);
+
+/**
+ * Follow brightness changes of the backlight policy.
+ *
+ * @param pct new brightness in percent of the maximum
+ */
+static void handle_brightness_change(uint8_t pct);
+
+/**
+ * Pause rendering while another VT owns the display and restore the screen when it comes back.
+ *
+ * @param is_active false before the VT is released, true after it was reacquired
  */
-static void set_theme(bool is_dark);
+static void handle_terminal_switch(bool is_active);
 
 /**
- * Handle termination signals sent to the process.
+ * Follow display state changes.
  *
- * @param signum the signal's number
+ * @param state new state
  */
-static void sigaction_handler(int signum);
+static void handle_display_state_change(display_state_t state);
 
 /**
  * Return current battery capacity
@@ -94,167 +129,311 @@ static void sigaction_handler(int signum);
 static int read_battery_capacity(void);
 
 /**
- * Update the battery level
+ * Read the battery temperature
  *
- * @param *arg is unused
+ * @param deci_celsius pointer to write the temperature in tenths of a degree Celsius into
+ * @return true on success, false if the battery doesn't report its temperature
  */
-static void *update_battery_level(void *arg);
+static bool read_battery_temperature(int *deci_celsius);
 
 /**
- * Check charger status, if device stopped charging, exit out
+ * Pass the battery capacity and status to the UI
+ *
+ * @return true if the displayed capacity changed, false otherwise
+ */
+static bool update_battery_level(void);
+
+/**
+ * Follow the battery status, wake the display if the charging state changed
+ *
+ * @return true if the status changed, false otherwise
+ */
+static bool update_battery_status(void);
+
+/**
+ * Read the current battery status (e.g. "Charging" or "Full")
+ *
+ * @param buffer buffer to write the status into
+ * @param size size of the buffer
+ * @return true on success, false otherwise
+ */
+static bool read_battery_status(char *buffer, size_t size);
+
+/**
+ * Handle a power supply uevent, read the online state and the battery right away
+ *
+ * @param action uevent action
+ * @param devpath path of the device in sysfs
+ */
+static void handle_power_supply_uevent(const char *action, const char *devpath);
+
+/**
+ * Sample a group of power supply attributes that the kernel notified
+ *
+ * @param watch notified group
+ */
+static void handle_power_supply_change(power_supply_watch_t watch);
+
+/**
+ * Poll a group of power supply attributes until notifications were seen for it, the online state is
+ * still polled slowly then
+ *
+ * @param watch group to update
+ */
+static void update_polling(power_supply_watch_t watch);
+
+/**
+ * Handle a key event, the power key toggles the display or leaves charger mode and other keys wake it
+ *
+ * @param code key code
+ * @param value 1 for press, 0 for release and 2 for autorepeat
+ * @param time_us kernel timestamp of the event
+ */
+static void handle_key(uint16_t code, int32_t value, int64_t time_us);
+
+/**
+ * Check charger status, if device stopped charging, exit out through the teardown path
  */
 static void check_charger_status();
 
 /**
- * Check charger status repeatedly
+ * Check charger status, called by the sampler
  *
- * @param *arg is unused
+ * @return false, the charger going offline ends charger mode
  */
-static void *check_charger(void* arg);
+static bool sample_online(void);
 
 /**
- * Returns 0 if device is in charger mode
+ * Update the battery level and status, called by the sampler
+ *
+ * @return true if the capacity or the status changed, false otherwise
  */
-static int bootreason_charger();
+static bool sample_battery(void);
+
+/**
+ * Override display parameters with command line options if necessary
+ *
+ * @param display display parameters to override
+ */
+static void apply_display_overrides(startup_display *display);
 
 /**
- * Lowers the brightness to 1/4th of max_brightness
+ * Record the first completed frame in the startup trace and complete input latency measurements
+ *
+ * @param disp_drv display driver
+ * @param time time spent rendering the frame in ms
+ * @param px number of rendered pixels
  */
-static void adjust_backlight();
+static void monitor_cb(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px);
+
+/**
+ * Returns 0 if device is in charger mode
+ */
+static int bootreason_charger();
+
 
 /**
  * Static functions
  */
 
 static void set_theme(bool is_alternate) {
-    theme_apply(&(themes_themes[is_alternate ? conf_opts.theme.alternate_id : conf_opts.theme.default_id]));
+    theme_switch(is_alternate);
+    is_alternate_theme = is_alternate;
+    charger_ui_refresh_theme();
+}
+
+static void log_stats(void) {
+    allocator_log_stats("stats");
+    steady_state_log_stats();
+    display_state_log_stats();
+    input_log_stats();
+    soft_dim_log_stats();
+    refresh_governor_log_stats();
+    charge_animation_log_stats();
+    sampler_log_stats();
+    power_supply_log_stats();
+}
+
+static void restore_backlight(void) {
+    display_state_restore();
+    backlight_restore();
+}
+
+static void release_display(void) {
+    pixel_shift_reset();
+    startup_release_backend();
 }
 
-static void sigaction_handler(int signum) {
-    LV_UNUSED(signum);
-    terminal_reset_current_terminal();
-    exit(0);
+static void handle_brightness_change(uint8_t pct) {
+    soft_dim_set_level(pct);
+    refresh_governor_set_dimmed(backlight_is_dimmed());
 }
 
 static int read_battery_capacity(void) {
-    FILE *file = fopen(BATTERY_CAPACITY, "r");
-    if (file == NULL) {
-        perror("Failed to open capacity file");
-        return -1;
+    int64_t capacity;
+    return power_supply_read_int(POWER_SUPPLY_CAPACITY, &capacity) ? (int)capacity : -1;
+}
+
+static bool read_battery_temperature(int *deci_celsius) {
+    int64_t temperature;
+    if (!power_supply_read_int(POWER_SUPPLY_TEMP, &temperature)) {
+        return false;
     }
 
-    int capacity;
-    fscanf(file, "%d", &capacity);
-    fclose(file);
+    *deci_celsius = (int)temperature;
+    return true;
+}
+
+static bool update_battery_level(void) {
+    if (!charger_ui_update(read_battery_capacity(), battery_status)) {
+        return false;
+    }
 
-    return capacity;
+    backlight_set_battery(charger_ui_get_capacity(), strcmp(battery_status, "Full") == 0);
+    return true;
 }
 
-static void *update_battery_level(void *arg) {
-    (void)arg; // unused, don't throw a warning
-
-    while (1) {
-        int capacity = read_battery_capacity();
-        if (capacity >= 0 && capacity <= 100) {
-            if (capacity == 100) {
-                lv_obj_set_size(battery_fill, LV_PCT(100), 99 * 8); // on 100, it goes out of the border radius, because of rounded corners, don't go above 99
-            // levels 1 to 12 are a little different as we have rounded corners and need to take care of it
-            } else if (capacity == 1) {
-                lv_obj_set_size(battery_fill, LV_PCT(80), capacity * 8);
-            } else if (capacity == 2) {
-                lv_obj_set_size(battery_fill, LV_PCT(82), capacity * 8);
-            } else if (capacity == 3) {
-                lv_obj_set_size(battery_fill, LV_PCT(83), capacity * 8);
-            } else if (capacity == 4) {
-                lv_obj_set_size(battery_fill, LV_PCT(84), capacity * 8);
-            } else if (capacity == 5) {
-                lv_obj_set_size(battery_fill, LV_PCT(86), capacity * 8);
-            } else if (capacity == 6) {
-                lv_obj_set_size(battery_fill, LV_PCT(88), capacity * 8);
-            } else if (capacity == 7) {
-                lv_obj_set_size(battery_fill, LV_PCT(89), capacity * 8);
-            } else if (capacity == 8) {
-                lv_obj_set_size(battery_fill, LV_PCT(91), capacity * 8);
-            } else if (capacity == 9) {
-                lv_obj_set_size(battery_fill, LV_PCT(92), capacity * 8);
-            } else if (capacity == 10) {
-                lv_obj_set_size(battery_fill, LV_PCT(94), capacity * 8);
-            } else if (capacity == 11) {
-                lv_obj_set_size(battery_fill, LV_PCT(96), capacity * 8);
-            } else if (capacity == 12) {
-                lv_obj_set_size(battery_fill, LV_PCT(98), capacity * 8);
-            } else {
-                lv_obj_set_size(battery_fill, LV_PCT(100), capacity * 8);
-            }
-
-            lv_label_set_text_fmt(battery_label, "%d%%", capacity);
-            lv_obj_align(battery_fill, LV_ALIGN_BOTTOM_MID, 0, 0);
-        }
+static bool update_battery_status(void) {
+    /* Capacity updates arrive as uevents too, only wake up for actual state changes */
+    char status[sizeof(battery_status)];
+    if (!read_battery_status(status, sizeof(status)) || strcmp(status, battery_status) == 0) {
+        return false;
+    }
+
+    strcpy(battery_status, status);
+    power_policy_status_changed(battery_status);
+    backlight_set_battery(charger_ui_get_capacity(), strcmp(battery_status, "Full") == 0);
+    display_state_activity();
+    return true;
+}
 
-        sleep(1);
+static bool read_battery_status(char *buffer, size_t size) {
+    return power_supply_read_string(POWER_SUPPLY_STATUS, buffer, size);
+}
+
+static void handle_power_supply_uevent(const char *action, const char *devpath) {
+    /* Chargers may come and go, e.g. Type-C sources */
+    power_supply_handle_uevent(action, devpath);
+
+    /* Unplugging and capacity changes are handled right away instead of on the next sample */
+    sample_online();
+    sample_battery();
+}
+
+static void handle_power_supply_change(power_supply_watch_t watch) {
+    if (watch == POWER_SUPPLY_WATCH_ONLINE) {
+        sample_online();
+    } else {
+        sample_battery();
     }
 
-    return NULL;
+    update_polling(watch);
 }
 
-static void check_charger_status() {
-    FILE* file = fopen(CHARGER_ONLINE, "r");
-    if (file == NULL) {
-        perror("Failed to open file");
-        exit(1);
+static void update_polling(power_supply_watch_t watch) {
+    bool is_watched = power_supply_is_watched(watch);
+    if (watch == POWER_SUPPLY_WATCH_ONLINE) {
+        /* Unplugging is the last change, keep a slow safety net instead of betting on one notification */
+        sampler_set_relaxed(SAMPLER_CHANNEL_ONLINE, is_watched);
+    } else {
+        sampler_set_enabled(SAMPLER_CHANNEL_BATTERY, !is_watched);
     }
+}
 
-    int status;
-    fscanf(file, "%d", &status);
-    fclose(file);
+static void handle_key(uint16_t code, int32_t value, int64_t time_us) {
+    bool was_on = display_state_is_on();
 
-    if (status == 0) {
-        printf("Charger is offline. exiting\n");
-        exit(0);
+    if (code == KEY_POWER) {
+        power_key_handle(value, time_us);
+    } else if (value == 1) {
+        display_state_activity();
+    }
+
+    if (value != 1) {
+        return;
+    }
+
+    power_policy_user_activity();
+
+    /* Interaction often comes right before unplugging */
+    sampler_speed_up(SAMPLER_CHANNEL_ONLINE);
+
+    /* Waking up is visible as soon as the backlight is on */
+    if (!was_on && display_state_is_on()) {
+        input_mark_pixels_visible();
+    }
+}
+
+static void handle_terminal_switch(bool is_active) {
+    display_state_set_away(!is_active);
+    if (is_active) {
+        pixel_shift_restore();
+        frame_cache_restore();
     }
 }
 
-static void *check_charger(void* arg) {
-    (void)arg; // unused, don't throw a warning
+static void handle_display_state_change(display_state_t state) {
+    charger_ui_set_visible(display_state_is_on());
 
-    while (1) {
-        check_charger_status();
-        sleep(1);
+    /* Without a backlight the panel stays lit, flush the black frame soft dimming now renders
+     * before lvgl stops running */
+    if (state == DISPLAY_STATE_OFF && !backlight_is_available()) {
+        lv_refr_now(NULL);
     }
-    return NULL;
 }
 
-static void adjust_backlight() {
-    FILE* file = fopen(MAX_BRIGHTNESS_PATH, "r");
-    if (file == NULL) {
-        printf("Failed to open max brightness file\n");
-        return;
+static void check_charger_status() {
+    int online = power_supply_is_online();
+    if (online < 0) {
+        shutdown_exit(EXIT_FAILURE, "Charger status unavailable");
     }
 
-    int max_brightness;
-    if (fscanf(file, "%d", &max_brightness) != 1) {
-        printf("Failed to read max brightness\n");
-        fclose(file);
-        return;
+    if (online == 0) {
+        shutdown_exit(EXIT_SUCCESS, "Charger is offline");
     }
-    fclose(file);
+}
+
+static bool sample_online(void) {
+    check_charger_status();
+    return false;
+}
 
-    int new_brightness = max_brightness / 4;
+static bool sample_battery(void) {
+    steady_state_end_tick();
 
-    file = fopen(BRIGHTNESS_PATH, "w");
-    if (file == NULL) {
-        printf("Failed to open brightness file\n");
-        return;
+    int deci_celsius;
+    if (conf_opts.refresh.hot_temperature > 0 && read_battery_temperature(&deci_celsius)) {
+        refresh_governor_set_temperature(deci_celsius);
     }
 
-    if (fprintf(file, "%d", new_brightness) < 0) {
-        printf("Failed to write new brightness\n");
-        fclose(file);
-        return;
+    /* The status first, the UI passes it on to the estimator */
+    bool has_changed = update_battery_status();
+    return update_battery_level() || has_changed;
+}
+
+static void apply_display_overrides(startup_display *display) {
+    if (cli_options.hor_res > 0) {
+        display->hor_res = cli_options.hor_res;
     }
-    fclose(file);
+    if (cli_options.ver_res > 0) {
+        display->ver_res = cli_options.ver_res;
+    }
+    if (cli_options.dpi > 0) {
+        display->dpi = cli_options.dpi;
+    }
+}
+
+static void monitor_cb(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px) {
+    LV_UNUSED(disp_drv);
+    LV_UNUSED(time);
+    LV_UNUSED(px);
 
-    printf("Backlight adjusted to %d\n", new_brightness);
+    if (first_flush_time_us < 0) {
+        first_flush_time_us = trace_now_us();
+        trace_mark("first-flush");
+    }
+
+    input_mark_pixels_visible();
 }
 
 static int bootreason_charger() {
@@ -291,81 +470,73 @@ static int bootreason_charger() {
  */
 
 int main(int argc, char *argv[]) {
+    int phase = trace_begin("bootreason");
     if (!bootreason_charger()) {
         printf("Device is not in charger mode\n");
         exit(0);
     }
+    trace_end(phase);
 
+    phase = trace_begin("charger-status");
+    if (!power_supply_init()) {
+        printf("No power supplies found\n");
+    }
     check_charger_status();
+    trace_end(phase);
 
-    struct stat buffer;
-    if (stat("/usr/bin/plymouth", &buffer) == 0) { // plymouth will block minui
-        system("plymouth quit");
-    }
+    /* Hand the display over from plymouth in the background, plymouth will block minui */
+    startup_quit_plymouth();
 
     /* Parse command line options */
+    phase = trace_begin("cli");
     cli_parse_opts(argc, argv, &cli_options);
+    trace_end(phase);
 
     /* Parse config files */
+    phase = trace_begin("config");
     config_parse(cli_options.config_files, cli_options.num_config_files, &conf_opts);
+    trace_end(phase);
+
+    /* Only records the themes and builds their fill colors, the splash needs them before LVGL is up */
+    theme_prepare(&(themes_themes[conf_opts.theme.default_id]), &(themes_themes[conf_opts.theme.alternate_id]));
 
-    /* Prepare current TTY and clean up on termination */
-    terminal_prepare_current_terminal();
-    struct sigaction action;
-    memset(&action, 0, sizeof(action));
-    action.sa_handler = sigaction_handler;
-    sigaction(SIGINT, &action, NULL);
-    sigaction(SIGTERM, &action, NULL);
+    /* Let the backend thread draw the current level as soon as plymouth has released the display */
+    int capacity = read_battery_capacity();
+    if (capacity >= 0 && capacity <= 100) {
+        splash_set_level(capacity, charger_ui_get_fill_width_pct(capacity), lv_color_to32(theme_get_fill_color(capacity)) & 0xFFFFFF);
+    }
+
+    /* Receive signals on the event loop, this must happen before the backend thread inherits the signal mask */
+    event_loop_init();
+    shutdown_add_signal(TERMINAL_SWITCH_SIGNAL, terminal_handle_switch_signal);
+    shutdown_init(log_stats);
+    shutdown_register(SHUTDOWN_STAGE_SAMPLING, sampler_stop);
+    shutdown_register(SHUTDOWN_STAGE_BACKLIGHT, restore_backlight);
+    shutdown_register(SHUTDOWN_STAGE_TERMINAL, terminal_reset_current_terminal);
+    shutdown_register(SHUTDOWN_STAGE_DISPLAY, release_display);
+
+    /* Prepare current TTY and initialise the display backend in the background */
+    startup_init_backend_async(conf_opts.general.backend);
 
     /* Initialise LVGL and set up logging callback */
+    phase = trace_begin("lv-init");
     lv_init();
+    trace_end(phase);
 
     /* Initialise display driver */
     static lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);
 
-    /* Initialise framebuffer driver and query display size */
-    uint32_t hor_res = 0;
-    uint32_t ver_res = 0;
-    uint32_t dpi = 0;
-
-    switch (conf_opts.general.backend) {
-#if USE_FBDEV
-    case BACKENDS_BACKEND_FBDEV:
-        fbdev_init();
-        fbdev_get_sizes(&hor_res, &ver_res, &dpi);
-        disp_drv.flush_cb = fbdev_flush;
-        break;
-#endif /* USE_FBDEV */
-#if USE_DRM
-    case BACKENDS_BACKEND_DRM:
-        drm_init();
-        drm_get_sizes((lv_coord_t *)&hor_res, (lv_coord_t *)&ver_res, &dpi);
-        disp_drv.flush_cb = drm_flush;
-        break;
-#endif /* USE_DRM */
-#if USE_MINUI
-    case BACKENDS_BACKEND_MINUI:
-        minui_init();
-        minui_get_sizes(&hor_res, &ver_res, &dpi);
-        disp_drv.flush_cb = minui_flush;
-        break;
-#endif /* USE_MINUI */
-    default:
-        printf("Unable to find suitable backend\n");
-        exit(EXIT_FAILURE);
-    }
-
-    /* Override display parameters with command line options if necessary */
-    if (cli_options.hor_res > 0) {
-        hor_res = cli_options.hor_res;
-    }
-    if (cli_options.ver_res > 0) {
-        ver_res = cli_options.ver_res;
-    }
-    if (cli_options.dpi > 0) {
-        dpi = cli_options.dpi;
+    /* Query display size, build the UI concurrently with the backend initialisation if it is known early */
+    startup_display display = { 0 };
+    bool is_probed = startup_probe_display(conf_opts.general.backend, &display);
+    if (!is_probed) {
+        startup_wait_backend(&display);
     }
+    apply_display_overrides(&display);
+    uint32_t hor_res = display.hor_res;
+    uint32_t ver_res = display.ver_res;
+    uint32_t dpi = display.dpi;
 
     /* Prepare display buffer */
     const size_t buf_size = hor_res * ver_res / 10; /* At least 1/10 of the display size is recommended */
@@ -380,60 +551,109 @@ int main(int argc, char *argv[]) {
     disp_drv.offset_x = cli_options.x_offset;
     disp_drv.offset_y = cli_options.y_offset;
     disp_drv.dpi = dpi;
-    lv_disp_drv_register(&disp_drv);
+    disp_drv.flush_cb = display.flush_cb;
+    disp_drv.monitor_cb = monitor_cb;
+    lv_disp_t *disp = lv_disp_drv_register(&disp_drv);
 
+    phase = trace_begin("ui");
     lv_obj_set_style_bg_color(lv_scr_act(), lv_color_black(), LV_PART_MAIN);
 
-    set_theme(0);
-
-    /* Battery */
-    lv_obj_t *battery = lv_obj_create(lv_scr_act());
-    lv_obj_set_size(battery, 400, 800);
-    lv_obj_align(battery, LV_ALIGN_CENTER, 0, 0);
-    lv_obj_set_style_border_width(battery, 5, LV_PART_MAIN);
-    lv_obj_set_style_border_color(battery, lv_color_white(), LV_PART_MAIN);
-    lv_obj_set_style_radius(battery, 60, LV_PART_MAIN);
-    lv_obj_set_style_pad_all(battery, 0, LV_PART_MAIN);
-
-    /* Green fill */
-    battery_fill = lv_obj_create(battery);
-    lv_obj_set_size(battery_fill, LV_PCT(100), LV_PCT(0));
-    lv_obj_align(battery_fill, LV_ALIGN_BOTTOM_MID, 0, 0);
-    lv_obj_set_style_bg_color(battery_fill, lv_color_hex(0x00FF00), LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(battery_fill, LV_OPA_COVER, LV_PART_MAIN);
-    lv_obj_set_style_radius(battery_fill, 55, LV_PART_MAIN);
-    lv_obj_set_style_border_width(battery_fill, 0, LV_PART_MAIN);
-    lv_obj_set_style_pad_all(battery_fill, 5, LV_PART_MAIN);
-
-    /* Battery's tip */
-    lv_obj_t *battery_tip = lv_obj_create(lv_scr_act());
-    lv_obj_set_size(battery_tip, 140, 45);
-    lv_obj_align(battery_tip, LV_ALIGN_TOP_MID, 0, 745);
-    lv_obj_set_style_border_width(battery_tip, 5, LV_PART_MAIN);
-    lv_obj_set_style_border_color(battery_tip, lv_color_white(), LV_PART_MAIN);
-    lv_obj_set_style_radius(battery_tip, 30, LV_PART_MAIN);
-
-    /* Battery text label */
-    battery_label = lv_label_create(battery);
-    lv_label_set_text(battery_label, "");
-    lv_obj_align(battery_label, LV_ALIGN_CENTER, 0, 0);
-    static lv_style_t style;
-    lv_style_init(&style);
-    lv_style_set_text_font(&style, &lv_font_montserrat_48);
-    lv_obj_add_style(battery_label, &style, 0);
-
-    adjust_backlight();
-
-    pthread_t battery_thread;
-    pthread_create(&battery_thread, NULL, update_battery_level, NULL);
-
-    pthread_t charger_thread;
-    pthread_create(&charger_thread, NULL, check_charger, NULL);
-
-    /* Run lvgl in "tickless" mode */
+    set_theme(is_alternate_theme);
+
+    charger_ui_init(lv_scr_act(), &(conf_opts.general));
+    update_battery_level();
+    trace_end(phase);
+
+    /* Wait for the backend if the UI was built concurrently */
+    if (is_probed) {
+        startup_display actual;
+        startup_wait_backend(&actual);
+        apply_display_overrides(&actual);
+
+        disp_drv.flush_cb = actual.flush_cb;
+        if (actual.hor_res != hor_res || actual.ver_res != ver_res || actual.dpi != dpi) {
+            printf("Display changed from %ux%u@%u to %ux%u@%u during startup\n", hor_res, ver_res, dpi,
+                actual.hor_res, actual.ver_res, actual.dpi);
+            disp_drv.hor_res = actual.hor_res;
+            disp_drv.ver_res = actual.ver_res;
+            disp_drv.dpi = actual.dpi;
+            lv_disp_drv_update(disp, &disp_drv);
+        }
+    }
+
+    phase = trace_begin("backlight");
+    bool has_backlight = backlight_init(&(conf_opts.backlight));
+    backlight_set_enabled(true);
+    if (!has_backlight) {
+        /* Apply the brightness to the pixels instead. This wraps the flush callback before the
+         * frame cache does, so that the cache keeps undimmed pixels. */
+        soft_dim_init(disp, backlight_get_target_pct());
+    }
+    backlight_set_change_cb(handle_brightness_change);
+    trace_end(phase);
+
+    /* Poll the online state and the battery, backing off while they are stable */
+    if (!sampler_init(&(conf_opts.sampling), sample_online, sample_battery)) {
+        printf("Failed to start sampling\n");
+    }
+
+    /* Rely on sysfs_notify() instead of polling once the attributes proved to be notified */
+    power_supply_watch(handle_power_supply_change);
+    for (int i = 0; i < POWER_SUPPLY_WATCH_COUNT; ++i) {
+        update_polling((power_supply_watch_t)i);
+    }
+
+    /* Move the image against burn-in, this changes the display's size before anything is cached */
+    pixel_shift_init(disp, conf_opts.general.backend, conf_opts.general.pixel_shift_interval);
+
+    /* Keep the last frame in memory if VT switches need to be handled */
+    if (terminal_is_switch_controlled()) {
+        frame_cache_init(disp);
+    }
+
+    /* Render the first frame right away and end the startup allocation phase */
+    phase = trace_begin("first-frame");
+    lv_refr_now(NULL);
+    trace_end(phase);
+    trace_report(cli_options.trace_file);
+    if (splash_get_shown_time_us() >= 0 && first_flush_time_us >= 0) {
+        int64_t lead_us = first_flush_time_us - splash_get_shown_time_us();
+        printf("Splash appeared %lld.%01lldms before the first LVGL frame\n", (long long)(lead_us / 1000),
+            (long long)((lead_us % 1000) / 100));
+    }
+    allocator_end_startup();
+
+    /* Count allocations, invalidations and flushes per tick if requested */
+    if (cli_options.check_steady_state || cli_options.verbose) {
+        steady_state_init(disp, cli_options.check_steady_state);
+    }
+
+    /* Only wake up for refreshes while something changes */
+    refresh_governor_init(disp, conf_opts.general.backend, &(conf_opts.refresh));
+
+    /* Turn the display off when idle and wake it on key presses or charger changes, power off on timeout */
+    display_state_init(conf_opts.general.backend, conf_opts.general.display_timeout);
+    display_state_set_change_cb(handle_display_state_change);
+    terminal_set_switch_cb(handle_terminal_switch);
+    power_key_init(conf_opts.general.long_press_command);
+    if (!input_init(disp, handle_key)) {
+        printf("No input devices found\n");
+    }
+    power_policy_init(conf_opts.general.timeout, conf_opts.general.full_action);
+    if (read_battery_status(battery_status, sizeof(battery_status))) {
+        power_policy_status_changed(battery_status);
+        update_battery_level();
+    }
+    uevent_init("power_supply", handle_power_supply_uevent);
+
+    /* Run lvgl in "tickless" mode, while the display is off only the event loop runs */
     while(1) {
-        lv_task_handler();
-        usleep(5000);
+        int timeout_ms = -1;
+        if (display_state_is_on()) {
+            uint32_t time_till_next = refresh_governor_get_timeout(lv_timer_handler());
+            timeout_ms = time_till_next == LV_NO_TIMER_READY ? -1 : (int)time_till_next;
+        }
+        event_loop_run_once(timeout_ms);
     }
 
     return 0;
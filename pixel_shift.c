@@ -0,0 +1,431 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "pixel_shift.h"
+
+#include "display_state.h"
+#include "event_loop.h"
+
+#include "lv_drv_conf.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <linux/fb.h>
+
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/timerfd.h>
+
+
+/**
+ * Static variables
+ */
+
+typedef enum {
+    /* Move the fbdev scanout within the virtual resolution */
+    PIXEL_SHIFT_MODE_PAN,
+    /* Move the display offset and the pixels in the mapped framebuffer */
+    PIXEL_SHIFT_MODE_MOVE,
+    /* Move the display offset and redraw */
+    PIXEL_SHIFT_MODE_REDRAW
+} pixel_shift_mode_t;
+
+static const char *mode_names[] = { "panning", "moving the framebuffer", "redrawing" };
+
+/* Positions visited in turn, in units of half the available range per axis. Consecutive
+ * positions are one unit apart so that the image never jumps across the whole range. */
+static const int8_t positions[][2] = {
+    { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 }
+};
+
+static lv_disp_t *shifted_disp = NULL;
+static pixel_shift_mode_t mode = PIXEL_SHIFT_MODE_REDRAW;
+static int timer_fd = -1;
+static int position_index = 0;
+
+/* Range of the shift per axis, relative to the base position */
+static int min_x = 0;
+static int max_x = 0;
+static int min_y = 0;
+static int max_y = 0;
+static int shift_x = 0;
+static int shift_y = 0;
+static lv_coord_t base_offset_x = 0;
+static lv_coord_t base_offset_y = 0;
+
+static int fb_fd = -1;
+static uint8_t *fb_map = NULL;
+static size_t fb_map_size = 0;
+static struct fb_var_screeninfo base_vinfo;
+static uint32_t fb_line_length = 0;
+static uint32_t fb_bytes_per_pixel = 0;
+static uint16_t pan_step_x = 0;
+static uint16_t pan_step_y = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Open and map the framebuffer.
+ *
+ * @return true on success, false otherwise
+ */
+static bool open_framebuffer(void);
+
+/**
+ * Compute the pan range along one axis.
+ *
+ * @param margin virtual pixels beyond the visible area
+ * @param step pan step of the driver, 0 if panning is unsupported
+ * @return largest usable pan
+ */
+static int get_pan_range(uint32_t margin, uint16_t step);
+
+/**
+ * Round a pan position down to the driver's granularity.
+ *
+ * @param value position along one axis
+ * @param step pan step of the driver along the axis
+ * @return position the scanout actually moves to
+ */
+static int round_to_step(int value, uint16_t step);
+
+/**
+ * Pan the scanout to a position.
+ *
+ * @param x horizontal shift from the base position
+ * @param y vertical shift from the base position
+ * @return true on success, false otherwise
+ */
+static bool pan(int x, int y);
+
+/**
+ * Clear a rectangle of the mapped framebuffer.
+ *
+ * @param x left edge in virtual pixels
+ * @param y top edge in virtual pixels
+ * @param width width in pixels
+ * @param height height in pixels
+ */
+static void clear_rect(int x, int y, int width, int height);
+
+/**
+ * Move the pixels of the display's area in the mapped framebuffer and clear what they uncover.
+ *
+ * @param dx horizontal distance
+ * @param dy vertical distance
+ */
+static void move_pixels(int dx, int dy);
+
+/**
+ * Move the image to a position.
+ *
+ * @param x horizontal shift from the base position
+ * @param y vertical shift from the base position
+ */
+static void apply_shift(int x, int y);
+
+/**
+ * Handle expiry of the shift timer.
+ *
+ * @param fd timer file descriptor
+ * @param events is unused
+ * @param user_data is unused
+ */
+static void handle_shift_timer(int fd, uint32_t events, void *user_data);
+
+
+/**
+ * Static functions
+ */
+
+static bool open_framebuffer(void) {
+#if USE_FBDEV
+    fb_fd = open(FBDEV_PATH, O_RDWR | O_CLOEXEC);
+    if (fb_fd < 0) {
+        return false;
+    }
+
+    struct fb_fix_screeninfo finfo;
+    if (ioctl(fb_fd, FBIOGET_VSCREENINFO, &base_vinfo) != 0 || ioctl(fb_fd, FBIOGET_FSCREENINFO, &finfo) != 0
+        || base_vinfo.bits_per_pixel % 8 != 0) {
+        close(fb_fd);
+        fb_fd = -1;
+        return false;
+    }
+
+    fb_map = mmap(NULL, finfo.smem_len, PROT_READ | PROT_WRITE, MAP_SHARED, fb_fd, 0);
+    if (fb_map == MAP_FAILED) {
+        fb_map = NULL;
+        close(fb_fd);
+        fb_fd = -1;
+        return false;
+    }
+
+    fb_map_size = finfo.smem_len;
+    fb_line_length = finfo.line_length;
+    fb_bytes_per_pixel = base_vinfo.bits_per_pixel / 8;
+    pan_step_x = finfo.xpanstep;
+    pan_step_y = finfo.ypanstep;
+    return true;
+#else
+    return false;
+#endif /* USE_FBDEV */
+}
+
+static int get_pan_range(uint32_t margin, uint16_t step) {
+    if (step == 0) {
+        return 0;
+    }
+
+    int range = LV_MIN((int)margin, 2 * PIXEL_SHIFT_MAX);
+    return range - range % step;
+}
+
+static int round_to_step(int value, uint16_t step) {
+    return step > 1 ? value - value % step : value;
+}
+
+static bool pan(int x, int y) {
+#if USE_FBDEV
+    /* Round down to the driver's granularity, the range is a multiple of it */
+    struct fb_var_screeninfo vinfo = base_vinfo;
+    vinfo.xoffset += round_to_step(x, pan_step_x);
+    vinfo.yoffset += round_to_step(y, pan_step_y);
+    if (ioctl(fb_fd, FBIOPAN_DISPLAY, &vinfo) != 0) {
+        perror("Failed to pan framebuffer");
+        return false;
+    }
+    return true;
+#else
+    LV_UNUSED(x);
+    LV_UNUSED(y);
+    return false;
+#endif /* USE_FBDEV */
+}
+
+static void clear_rect(int x, int y, int width, int height) {
+    if (fb_map == NULL || width <= 0 || height <= 0) {
+        return;
+    }
+
+    for (int row = y; row < y + height; ++row) {
+        size_t start = (size_t)row * fb_line_length + (size_t)x * fb_bytes_per_pixel;
+        size_t length = (size_t)width * fb_bytes_per_pixel;
+        if (start + length <= fb_map_size) {
+            memset(fb_map + start, 0, length);
+        }
+    }
+}
+
+static void move_pixels(int dx, int dy) {
+    int width = lv_disp_get_hor_res(shifted_disp);
+    int height = lv_disp_get_ver_res(shifted_disp);
+    int old_x = (int)base_vinfo.xoffset + shifted_disp->driver->offset_x;
+    int old_y = (int)base_vinfo.yoffset + shifted_disp->driver->offset_y;
+    int new_x = old_x + dx;
+    int new_y = old_y + dy;
+    size_t row_length = (size_t)width * fb_bytes_per_pixel;
+
+    /* Walk the rows against the direction of the move so that no source row is overwritten early */
+    for (int i = 0; i < height; ++i) {
+        int row = dy > 0 ? height - 1 - i : i;
+        size_t src = (size_t)(old_y + row) * fb_line_length + (size_t)old_x * fb_bytes_per_pixel;
+        size_t dst = (size_t)(new_y + row) * fb_line_length + (size_t)new_x * fb_bytes_per_pixel;
+        if (src + row_length <= fb_map_size && dst + row_length <= fb_map_size) {
+            memmove(fb_map + dst, fb_map + src, row_length);
+        }
+    }
+
+    /* Clear the rows and columns of the old area that the new one doesn't cover */
+    clear_rect(old_x, dy > 0 ? old_y : new_y + height, width, LV_MIN(LV_ABS(dy), height));
+    clear_rect(dx > 0 ? old_x : new_x + width, LV_MAX(old_y, new_y), LV_MIN(LV_ABS(dx), width),
+        height - LV_ABS(dy));
+}
+
+static void apply_shift(int x, int y) {
+    if (x == shift_x && y == shift_y) {
+        return;
+    }
+
+    switch (mode) {
+    case PIXEL_SHIFT_MODE_PAN:
+        if (!pan(x, y)) {
+            return;
+        }
+        break;
+    case PIXEL_SHIFT_MODE_MOVE:
+        move_pixels(x - shift_x, y - shift_y);
+        shifted_disp->driver->offset_x = base_offset_x + x;
+        shifted_disp->driver->offset_y = base_offset_y + y;
+        break;
+    case PIXEL_SHIFT_MODE_REDRAW:
+        shifted_disp->driver->offset_x = base_offset_x + x;
+        shifted_disp->driver->offset_y = base_offset_y + y;
+        lv_obj_invalidate(lv_scr_act());
+        break;
+    }
+
+    shift_x = x;
+    shift_y = y;
+}
+
+static void handle_shift_timer(int fd, uint32_t events, void *user_data) {
+    (void)events;
+    (void)user_data;
+
+    uint64_t expirations;
+    if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations) || !display_state_is_on()) {
+        return;
+    }
+
+    position_index = (position_index + 1) % (int)(sizeof(positions) / sizeof(positions[0]));
+    const int8_t *position = positions[position_index];
+    apply_shift((min_x + max_x + position[0] * (max_x - min_x)) / 2,
+        (min_y + max_y + position[1] * (max_y - min_y)) / 2);
+}
+
+
+/**
+ * Public functions
+ */
+
+void pixel_shift_init(lv_disp_t *disp, backends_backend_id_t backend, uint16_t interval_s) {
+    if (interval_s == 0) {
+        return;
+    }
+
+    shifted_disp = disp;
+
+    bool is_fbdev = false;
+#if USE_FBDEV
+    is_fbdev = backend == BACKENDS_BACKEND_FBDEV && open_framebuffer();
+#else
+    LV_UNUSED(backend);
+#endif /* USE_FBDEV */
+
+    if (is_fbdev) {
+        max_x = get_pan_range(base_vinfo.xres_virtual - base_vinfo.xres - base_vinfo.xoffset, pan_step_x);
+        max_y = get_pan_range(base_vinfo.yres_virtual - base_vinfo.yres - base_vinfo.yoffset, pan_step_y);
+    }
+
+    if (max_x > 0 || max_y > 0) {
+        mode = PIXEL_SHIFT_MODE_PAN;
+        pixel_shift_restore();
+    } else {
+        mode = is_fbdev ? PIXEL_SHIFT_MODE_MOVE : PIXEL_SHIFT_MODE_REDRAW;
+
+        /* Make room around the display to move it into */
+        lv_disp_drv_t *drv = disp->driver;
+        drv->hor_res -= 2 * PIXEL_SHIFT_MAX;
+        drv->ver_res -= 2 * PIXEL_SHIFT_MAX;
+        drv->offset_x += PIXEL_SHIFT_MAX;
+        drv->offset_y += PIXEL_SHIFT_MAX;
+        lv_disp_drv_update(disp, drv);
+
+        min_x = -PIXEL_SHIFT_MAX;
+        max_x = PIXEL_SHIFT_MAX;
+        min_y = -PIXEL_SHIFT_MAX;
+        max_y = PIXEL_SHIFT_MAX;
+    }
+
+    base_offset_x = disp->driver->offset_x;
+    base_offset_y = disp->driver->offset_y;
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd < 0) {
+        perror("Failed to create pixel shift timer");
+        return;
+    }
+
+    if (!event_loop_add_fd(timer_fd, EPOLLIN, handle_shift_timer, NULL)) {
+        close(timer_fd);
+        timer_fd = -1;
+        return;
+    }
+
+    struct itimerspec spec = { .it_interval = { .tv_sec = interval_s }, .it_value = { .tv_sec = interval_s } };
+    timerfd_settime(timer_fd, 0, &spec, NULL);
+
+    printf("Shifting the image every %us by %s (%d..%d, %d..%d)\n", interval_s, mode_names[mode], min_x, max_x,
+        min_y, max_y);
+}
+
+void pixel_shift_restore(void) {
+    if (shifted_disp == NULL) {
+        return;
+    }
+
+    if (mode == PIXEL_SHIFT_MODE_PAN) {
+        /* Everything that can scroll into view, to the right of and below the visible area */
+        int visible_x = (int)base_vinfo.xoffset;
+        int visible_y = (int)base_vinfo.yoffset;
+        clear_rect(visible_x + (int)base_vinfo.xres, visible_y, max_x, (int)base_vinfo.yres + max_y);
+        clear_rect(visible_x, visible_y + (int)base_vinfo.yres, (int)base_vinfo.xres, max_y);
+        pan(shift_x, shift_y);
+    } else if (mode == PIXEL_SHIFT_MODE_MOVE) {
+        clear_rect((int)base_vinfo.xoffset, (int)base_vinfo.yoffset, (int)base_vinfo.xres, (int)base_vinfo.yres);
+    }
+}
+
+void pixel_shift_get_panel_area(lv_disp_t *disp, lv_area_t *area) {
+    lv_area_set(area, 0, 0, lv_disp_get_hor_res(disp) - 1, lv_disp_get_ver_res(disp) - 1);
+    if (disp != shifted_disp) {
+        return;
+    }
+
+    if (mode == PIXEL_SHIFT_MODE_PAN) {
+        /* The scanout moved, the display's pixels appear shifted against the panel */
+        lv_area_move(area, round_to_step(shift_x, pan_step_x), round_to_step(shift_y, pan_step_y));
+    } else {
+        /* The display was shrunk and sits at its offset inside the panel */
+        area->x2 += 2 * PIXEL_SHIFT_MAX;
+        area->y2 += 2 * PIXEL_SHIFT_MAX;
+        lv_area_move(area, -PIXEL_SHIFT_MAX - shift_x, -PIXEL_SHIFT_MAX - shift_y);
+    }
+}
+
+void pixel_shift_reset(void) {
+    if (timer_fd >= 0) {
+        event_loop_remove_fd(timer_fd);
+        close(timer_fd);
+        timer_fd = -1;
+    }
+
+    if (mode == PIXEL_SHIFT_MODE_PAN && (shift_x != 0 || shift_y != 0)) {
+        pan(0, 0);
+    }
+
+    if (fb_map != NULL) {
+        munmap(fb_map, fb_map_size);
+        fb_map = NULL;
+    }
+    if (fb_fd >= 0) {
+        close(fb_fd);
+        fb_fd = -1;
+    }
+}
@@ -0,0 +1,66 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PIXEL_SHIFT_H
+#define PIXEL_SHIFT_H
+
+#include "backends.h"
+
+#include "lvgl/lvgl.h"
+
+#include <stdint.h>
+
+/* Largest distance (in pixels) the image is moved away from its original position per axis */
+#define PIXEL_SHIFT_MAX 3
+
+/**
+ * Periodically move the image by a few pixels against burn-in. On fbdev the scanout is panned if
+ * the virtual resolution leaves room for it. Otherwise the display is shrunk by PIXEL_SHIFT_MAX
+ * pixels per side and moved through its offset, with the pixels already on screen moved along
+ * where the framebuffer is accessible. Must be called before the first frame is flushed. Requires
+ * event_loop_init to have been called.
+ *
+ * @param disp display to move
+ * @param backend backend driving the display
+ * @param interval_s seconds between two shifts, 0 to disable
+ */
+void pixel_shift_init(lv_disp_t *disp, backends_backend_id_t backend, uint16_t interval_s);
+
+/**
+ * Reapply the current shift after another program used the display. Clears everything around the
+ * image, so it must be followed by a full redraw or restore of the frame.
+ */
+void pixel_shift_restore(void);
+
+/**
+ * Get the area the panel covers in the coordinates of a display, taking the current shift into
+ * account. Input that spans the whole panel, such as a touchscreen, maps onto this area.
+ *
+ * @param disp display to get the area for
+ * @param area pointer for writing the area into
+ */
+void pixel_shift_get_panel_area(lv_disp_t *disp, lv_area_t *area);
+
+/**
+ * Move the scanout back to where it was before pixel_shift_init. Used on teardown.
+ */
+void pixel_shift_reset(void);
+
+#endif /* PIXEL_SHIFT_H */
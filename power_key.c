@@ -0,0 +1,184 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "power_key.h"
+
+#include "display_state.h"
+#include "event_loop.h"
+#include "shutdown.h"
+#include "trace.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/reboot.h>
+#include <sys/timerfd.h>
+
+
+/**
+ * Static variables
+ */
+
+#define MAX_COMMAND_ARGS 16
+
+static const char *command = NULL;
+static int timer_fd = -1;
+
+/* Kernel timestamp of the current press, -1 while the key is up */
+static int64_t press_time_us = -1;
+/* True if the current press turned the display on, the release must not turn it off again */
+static bool has_woken = false;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Handle expiry of the long press timer.
+ *
+ * @param fd timer file descriptor
+ * @param events is unused
+ * @param user_data is unused
+ */
+static void handle_long_press(int fd, uint32_t events, void *user_data);
+
+/**
+ * Replace the process with the configured command. Returns only on failure.
+ */
+static void exec_command(void);
+
+/**
+ * Leave charger mode as fast as possible. The last frame stays on screen.
+ */
+static void leave_charger_mode(void);
+
+
+/**
+ * Static functions
+ */
+
+static void handle_long_press(int fd, uint32_t events, void *user_data) {
+    (void)events;
+    (void)user_data;
+
+    uint64_t expirations;
+    if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations) || press_time_us < 0) {
+        return;
+    }
+
+    leave_charger_mode();
+}
+
+static void exec_command(void) {
+    char buffer[256];
+    strncpy(buffer, command, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    char *argv[MAX_COMMAND_ARGS + 1];
+    int argc = 0;
+    for (char *token = strtok(buffer, " "); token && argc < MAX_COMMAND_ARGS; token = strtok(NULL, " ")) {
+        argv[argc++] = token;
+    }
+    argv[argc] = NULL;
+
+    if (argc == 0) {
+        return;
+    }
+
+    /* The continuation owns the console and display from here on */
+    shutdown_teardown();
+    execv(argv[0], argv);
+    perror("Failed to execute long press command");
+}
+
+static void leave_charger_mode(void) {
+    /* Nothing is torn down, the kernel resets the display and terminal on reboot anyway */
+    sync();
+
+    int64_t latency_us = trace_now_us() - press_time_us - POWER_KEY_LONG_PRESS_MS * 1000LL;
+    printf("Power key held, leaving charger mode %lld.%01lldms after the long press threshold\n",
+        (long long)(latency_us / 1000), (long long)((latency_us % 1000) / 100));
+    fflush(stdout);
+
+    if (command) {
+        exec_command();
+    }
+
+    reboot(RB_AUTOBOOT);
+    perror("Failed to reboot");
+}
+
+
+/**
+ * Public functions
+ */
+
+void power_key_init(const char *long_press_command) {
+    command = long_press_command;
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd < 0) {
+        perror("Failed to create long press timer");
+        return;
+    }
+
+    if (!event_loop_add_fd(timer_fd, EPOLLIN, handle_long_press, NULL)) {
+        close(timer_fd);
+        timer_fd = -1;
+    }
+}
+
+void power_key_handle(int32_t value, int64_t time_us) {
+    if (value == 1) {
+        /* Count the hold time from the kernel timestamp unless it is on a different clock */
+        int64_t now_us = trace_now_us();
+        int64_t held_us = now_us - time_us;
+        if (held_us < 0 || held_us >= POWER_KEY_LONG_PRESS_MS * 1000LL) {
+            time_us = now_us;
+            held_us = 0;
+        }
+
+        press_time_us = time_us;
+        has_woken = !display_state_is_on();
+        display_state_activity();
+
+        if (timer_fd >= 0) {
+            int64_t remaining_us = POWER_KEY_LONG_PRESS_MS * 1000LL - held_us;
+            struct itimerspec spec = { 0 };
+            spec.it_value.tv_sec = remaining_us / 1000000;
+            spec.it_value.tv_nsec = (remaining_us % 1000000) * 1000;
+            timerfd_settime(timer_fd, 0, &spec, NULL);
+        }
+    } else if (value == 0 && press_time_us >= 0) {
+        if (timer_fd >= 0) {
+            struct itimerspec spec = { 0 };
+            timerfd_settime(timer_fd, 0, &spec, NULL);
+        }
+
+        if (!has_woken) {
+            display_state_toggle();
+        }
+        press_time_us = -1;
+    }
+}
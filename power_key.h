@@ -0,0 +1,46 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef POWER_KEY_H
+#define POWER_KEY_H
+
+#include <stdint.h>
+
+/* Time (in ms) the power key needs to be held to leave charger mode */
+#define POWER_KEY_LONG_PRESS_MS 2000
+
+/**
+ * Prepare the long press timer on the event loop. Requires event_loop_init and
+ * display_state_init to have been called.
+ *
+ * @param long_press_command command to execute on a long press or NULL to reboot
+ */
+void power_key_init(const char *long_press_command);
+
+/**
+ * Handle a power key event. A press wakes the display, a short press toggles it and a long press
+ * leaves charger mode.
+ *
+ * @param value 1 for press, 0 for release and 2 for autorepeat
+ * @param time_us kernel timestamp of the event in microseconds since boot
+ */
+void power_key_handle(int32_t value, int64_t time_us);
+
+#endif /* POWER_KEY_H */
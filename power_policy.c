@@ -0,0 +1,218 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "power_policy.h"
+
+#include "display_state.h"
+#include "event_loop.h"
+#include "shutdown.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/reboot.h>
+#include <sys/timerfd.h>
+
+
+/**
+ * Static variables
+ */
+
+static const char *full_action_names[] = { "none", "blank", "poweroff" };
+
+static uint16_t timeout_s = 0;
+static power_policy_full_action_t full_action = POWER_POLICY_FULL_NONE;
+
+static int timeout_fd = -1;
+static int full_fd = -1;
+static bool is_full = false;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Create a one shot timer on the event loop.
+ *
+ * @param cb callback to invoke on expiry
+ * @return timer file descriptor or -1 on failure
+ */
+static int create_timer(event_loop_cb_t cb);
+
+/**
+ * Arm or disarm a one shot timer.
+ *
+ * @param fd timer file descriptor
+ * @param seconds time until expiry, 0 to disarm
+ */
+static void arm_timer(int fd, uint16_t seconds);
+
+/**
+ * Check that a timer really expired. Consumes the expiration count.
+ *
+ * @param fd timer file descriptor
+ * @return true if the timer expired, false otherwise
+ */
+static bool has_expired(int fd);
+
+/**
+ * Handle expiry of the poweroff timeout.
+ *
+ * @param fd timer file descriptor
+ * @param events is unused
+ * @param user_data is unused
+ */
+static void handle_timeout(int fd, uint32_t events, void *user_data);
+
+/**
+ * Handle expiry of the charge complete timer.
+ *
+ * @param fd timer file descriptor
+ * @param events is unused
+ * @param user_data is unused
+ */
+static void handle_full(int fd, uint32_t events, void *user_data);
+
+/**
+ * Power the device off.
+ *
+ * @param reason reason to log
+ */
+static void power_off(const char *reason);
+
+
+/**
+ * Static functions
+ */
+
+static int create_timer(event_loop_cb_t cb) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        perror("Failed to create timer");
+        return -1;
+    }
+
+    if (!event_loop_add_fd(fd, EPOLLIN, cb, NULL)) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static void arm_timer(int fd, uint16_t seconds) {
+    if (fd < 0) {
+        return;
+    }
+
+    struct itimerspec spec = { .it_value = { .tv_sec = seconds } };
+    timerfd_settime(fd, 0, &spec, NULL);
+}
+
+static bool has_expired(int fd) {
+    uint64_t expirations;
+    return read(fd, &expirations, sizeof(expirations)) == sizeof(expirations) && expirations > 0;
+}
+
+static void handle_timeout(int fd, uint32_t events, void *user_data) {
+    (void)events;
+    (void)user_data;
+
+    if (has_expired(fd)) {
+        power_off("Timeout elapsed");
+    }
+}
+
+static void handle_full(int fd, uint32_t events, void *user_data) {
+    (void)events;
+    (void)user_data;
+
+    if (!has_expired(fd) || !is_full) {
+        return;
+    }
+
+    if (full_action == POWER_POLICY_FULL_POWEROFF) {
+        power_off("Battery full");
+    } else if (full_action == POWER_POLICY_FULL_BLANK && display_state_is_on()) {
+        display_state_toggle();
+    }
+}
+
+static void power_off(const char *reason) {
+    printf("%s, powering off\n", reason);
+    fflush(stdout);
+
+    /* Leave the backlight, terminal and display in a defined state, the power off may take a while */
+    shutdown_teardown();
+    sync();
+    reboot(RB_POWER_OFF);
+    perror("Failed to power off");
+}
+
+
+/**
+ * Public functions
+ */
+
+void power_policy_init(uint16_t timeout, power_policy_full_action_t action) {
+    timeout_s = timeout;
+    full_action = action;
+
+    if (timeout_s > 0) {
+        timeout_fd = create_timer(handle_timeout);
+        arm_timer(timeout_fd, timeout_s);
+    }
+
+    if (full_action != POWER_POLICY_FULL_NONE) {
+        full_fd = create_timer(handle_full);
+    }
+}
+
+void power_policy_user_activity(void) {
+    arm_timer(timeout_fd, timeout_s);
+    if (is_full) {
+        arm_timer(full_fd, POWER_POLICY_FULL_IDLE_S);
+    }
+}
+
+void power_policy_status_changed(const char *status) {
+    bool was_full = is_full;
+    is_full = strcmp(status, "Full") == 0;
+
+    if (is_full && !was_full) {
+        arm_timer(full_fd, POWER_POLICY_FULL_IDLE_S);
+    } else if (!is_full) {
+        arm_timer(full_fd, 0);
+    }
+}
+
+bool power_policy_find_full_action(const char *name, power_policy_full_action_t *action) {
+    for (int i = 0; i < (int)(sizeof(full_action_names) / sizeof(full_action_names[0])); ++i) {
+        if (strcmp(name, full_action_names[i]) == 0) {
+            *action = (power_policy_full_action_t)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,69 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef POWER_POLICY_H
+#define POWER_POLICY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Time (in seconds) without user input before the charge complete action is taken */
+#define POWER_POLICY_FULL_IDLE_S 60
+
+/**
+ * Actions to take once the battery is full
+ */
+typedef enum {
+    POWER_POLICY_FULL_NONE,
+    POWER_POLICY_FULL_BLANK,
+    POWER_POLICY_FULL_POWEROFF
+} power_policy_full_action_t;
+
+/**
+ * Arm the poweroff timeout on the event loop. Requires event_loop_init and display_state_init to
+ * have been called.
+ *
+ * @param timeout seconds without user input after which the device is powered off, 0 to disable
+ * @param full_action action to take once the battery is full and there was no recent user input
+ */
+void power_policy_init(uint16_t timeout, power_policy_full_action_t full_action);
+
+/**
+ * Record user input. Restarts the poweroff timeout and postpones the charge complete action.
+ */
+void power_policy_user_activity(void);
+
+/**
+ * Record a change of the battery status.
+ *
+ * @param status new value of the status attribute (e.g. "Charging" or "Full")
+ */
+void power_policy_status_changed(const char *status);
+
+/**
+ * Find the charge complete action with a given name.
+ *
+ * @param name action name ("none", "blank" or "poweroff")
+ * @param action pointer for writing the action into
+ * @return true if the name matched, false otherwise
+ */
+bool power_policy_find_full_action(const char *name, power_policy_full_action_t *action);
+
+#endif /* POWER_POLICY_H */
@@ -0,0 +1,436 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "power_supply.h"
+
+#include "event_loop.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+
+
+/**
+ * Static variables
+ */
+
+#define POWER_SUPPLY_DIR "/sys/class/power_supply"
+#define NAME_SIZE 64
+
+typedef struct {
+    char name[NAME_SIZE];
+    /* The supply's online attribute */
+    int fd;
+} charger;
+
+typedef struct {
+    int fd;
+    power_supply_watch_t watch;
+    /* If true, the group is polled until this attribute proved to be notified and again once it fails */
+    bool is_required;
+    /* True once the kernel signalled a change, registering alone doesn't prove that the driver notifies */
+    bool has_notified;
+} watched_attribute;
+
+static const char *watch_names[POWER_SUPPLY_WATCH_COUNT] = { "online", "battery" };
+
+static const char *attribute_names[POWER_SUPPLY_ATTRIBUTE_COUNT] = {
+    "capacity", "status", "temp", "charge_now", "charge_full", "current_now"
+};
+
+static char battery_name[NAME_SIZE];
+static int battery_fds[POWER_SUPPLY_ATTRIBUTE_COUNT] = { -1, -1, -1, -1, -1, -1 };
+
+static charger chargers[POWER_SUPPLY_MAX_CHARGERS];
+static int num_chargers = 0;
+
+static power_supply_watch_cb_t watch_cb = NULL;
+static watched_attribute watched[POWER_SUPPLY_MAX_CHARGERS + 2];
+static int num_watched = 0;
+/* True while every attribute that decides a group's state is registered for notifications */
+static bool is_group_registered[POWER_SUPPLY_WATCH_COUNT] = { false };
+static uint32_t num_notifications[POWER_SUPPLY_WATCH_COUNT] = { 0 };
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Open an attribute of a supply.
+ *
+ * @param dir_fd file descriptor of the power_supply class directory
+ * @param name name of the supply
+ * @param attribute name of the attribute
+ * @return file descriptor or -1 if the supply doesn't have the attribute
+ */
+static int open_attribute(int dir_fd, const char *name, const char *attribute);
+
+/**
+ * Read an attribute of a supply once, without the trailing newline.
+ *
+ * @param dir_fd file descriptor of the power_supply class directory
+ * @param name name of the supply
+ * @param attribute name of the attribute
+ * @param buffer buffer to write the value into
+ * @param size size of the buffer
+ * @return true on success, false otherwise
+ */
+static bool read_attribute_once(int dir_fd, const char *name, const char *attribute, char *buffer, size_t size);
+
+/**
+ * Read an attribute from a file descriptor of the index, without the trailing newline.
+ *
+ * @param fd attribute file descriptor
+ * @param buffer buffer to write the value into
+ * @param size size of the buffer
+ * @return true on success, false otherwise
+ */
+static bool read_fd(int fd, char *buffer, size_t size);
+
+/**
+ * Watch an attribute for notifications. The attribute is read once, the kernel signals
+ * notifications that happened since the last read.
+ *
+ * @param fd attribute file descriptor
+ * @param watch group the attribute belongs to
+ * @param is_required true if the group's state depends on notifications of this attribute
+ * @return true if the attribute is watched, false otherwise
+ */
+static bool add_watch(int fd, power_supply_watch_t watch, bool is_required);
+
+/**
+ * Watch the attributes of the index.
+ */
+static void start_watching(void);
+
+/**
+ * Stop watching the attributes of the index.
+ */
+static void stop_watching(void);
+
+/**
+ * Re-read a notified attribute, which also re-arms the notification, and forward it.
+ *
+ * @param fd attribute file descriptor
+ * @param events is unused
+ * @param user_data watched attribute
+ */
+static void handle_notification(int fd, uint32_t events, void *user_data);
+
+/**
+ * Close all file descriptors of the index and empty it.
+ */
+static void clear_index(void);
+
+/**
+ * Rebuild the index from the supplies currently present.
+ *
+ * @return true if a battery or a charger was found, false otherwise
+ */
+static bool scan(void);
+
+
+/**
+ * Static functions
+ */
+
+static int open_attribute(int dir_fd, const char *name, const char *attribute) {
+    char path[NAME_SIZE + 32];
+    snprintf(path, sizeof(path), "%s/%s", name, attribute);
+    return openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+}
+
+static bool read_attribute_once(int dir_fd, const char *name, const char *attribute, char *buffer, size_t size) {
+    int fd = open_attribute(dir_fd, name, attribute);
+    if (fd < 0) {
+        return false;
+    }
+
+    bool is_ok = read_fd(fd, buffer, size);
+    close(fd);
+    return is_ok;
+}
+
+static bool read_fd(int fd, char *buffer, size_t size) {
+    if (fd < 0) {
+        return false;
+    }
+
+    ssize_t len = pread(fd, buffer, size - 1, 0);
+    if (len <= 0) {
+        return false;
+    }
+    buffer[len] = '\0';
+    buffer[strcspn(buffer, "\n")] = '\0';
+    return true;
+}
+
+static bool add_watch(int fd, power_supply_watch_t watch, bool is_required) {
+    if (fd < 0 || num_watched == (int)(sizeof(watched) / sizeof(watched[0]))) {
+        return false;
+    }
+
+    char buffer[32];
+    if (pread(fd, buffer, sizeof(buffer), 0) < 0) {
+        return false;
+    }
+
+    watched_attribute *attribute = &watched[num_watched];
+    *attribute = (watched_attribute){ .fd = fd, .watch = watch, .is_required = is_required };
+    if (!event_loop_add_fd(fd, EPOLLPRI | EPOLLERR, handle_notification, attribute)) {
+        return false;
+    }
+
+    ++num_watched;
+    return true;
+}
+
+static void start_watching(void) {
+    is_group_registered[POWER_SUPPLY_WATCH_ONLINE] = num_chargers > 0;
+    for (int i = 0; i < num_chargers; ++i) {
+        if (!add_watch(chargers[i].fd, POWER_SUPPLY_WATCH_ONLINE, true)) {
+            is_group_registered[POWER_SUPPLY_WATCH_ONLINE] = false;
+        }
+    }
+
+    /* Not every status change comes with a capacity change, but the status is read along */
+    is_group_registered[POWER_SUPPLY_WATCH_BATTERY] =
+        add_watch(battery_fds[POWER_SUPPLY_CAPACITY], POWER_SUPPLY_WATCH_BATTERY, true);
+    add_watch(battery_fds[POWER_SUPPLY_STATUS], POWER_SUPPLY_WATCH_BATTERY, false);
+}
+
+static void stop_watching(void) {
+    for (int i = 0; i < num_watched; ++i) {
+        if (watched[i].fd >= 0) {
+            event_loop_remove_fd(watched[i].fd);
+        }
+    }
+    num_watched = 0;
+
+    for (int i = 0; i < POWER_SUPPLY_WATCH_COUNT; ++i) {
+        is_group_registered[i] = false;
+    }
+}
+
+static void handle_notification(int fd, uint32_t events, void *user_data) {
+    (void)events;
+
+    watched_attribute *attribute = user_data;
+
+    /* A removed supply keeps signalling until the rescan, fall back to polling until then */
+    char buffer[32];
+    if (pread(fd, buffer, sizeof(buffer), 0) < 0) {
+        event_loop_remove_fd(fd);
+        attribute->fd = -1;
+        if (attribute->is_required) {
+            is_group_registered[attribute->watch] = false;
+        }
+    } else {
+        attribute->has_notified = true;
+        ++num_notifications[attribute->watch];
+    }
+
+    watch_cb(attribute->watch);
+}
+
+static void clear_index(void) {
+    stop_watching();
+
+    for (int i = 0; i < POWER_SUPPLY_ATTRIBUTE_COUNT; ++i) {
+        if (battery_fds[i] >= 0) {
+            close(battery_fds[i]);
+            battery_fds[i] = -1;
+        }
+    }
+    battery_name[0] = '\0';
+
+    for (int i = 0; i < num_chargers; ++i) {
+        close(chargers[i].fd);
+    }
+    num_chargers = 0;
+}
+
+static bool scan(void) {
+    clear_index();
+
+    int dir_fd = open(POWER_SUPPLY_DIR, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0) {
+        perror("Failed to open " POWER_SUPPLY_DIR);
+        return false;
+    }
+
+    DIR *dir = fdopendir(dup(dir_fd));
+    if (!dir) {
+        perror("Failed to read " POWER_SUPPLY_DIR);
+        close(dir_fd);
+        return false;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        const char *name = entry->d_name;
+        if (name[0] == '.' || strlen(name) >= NAME_SIZE) {
+            continue;
+        }
+
+        char type[32];
+        char scope[16];
+        if (!read_attribute_once(dir_fd, name, "type", type, sizeof(type))) {
+            continue;
+        }
+
+        /* Batteries of peripherals (e.g. a stylus) are in the device scope */
+        if (read_attribute_once(dir_fd, name, "scope", scope, sizeof(scope)) && strcmp(scope, "Device") == 0) {
+            continue;
+        }
+
+        if (strcmp(type, "Battery") == 0) {
+            /* Some gauges expose a second battery, prefer the conventional name if there are several */
+            char capacity[8];
+            if ((battery_name[0] == '\0' || strcmp(name, "battery") == 0)
+                && read_attribute_once(dir_fd, name, "capacity", capacity, sizeof(capacity))) {
+                strcpy(battery_name, name);
+            }
+        } else if (num_chargers < POWER_SUPPLY_MAX_CHARGERS) {
+            /* Mains, USB, wireless and Type-C sources all report whether they are online */
+            int fd = open_attribute(dir_fd, name, "online");
+            if (fd >= 0) {
+                strcpy(chargers[num_chargers].name, name);
+                chargers[num_chargers].fd = fd;
+                ++num_chargers;
+            }
+        }
+    }
+    closedir(dir);
+
+    if (battery_name[0] != '\0') {
+        for (int i = 0; i < POWER_SUPPLY_ATTRIBUTE_COUNT; ++i) {
+            battery_fds[i] = open_attribute(dir_fd, battery_name, attribute_names[i]);
+        }
+    }
+    close(dir_fd);
+
+    printf("Power supplies: battery %s, %d charger(s)", battery_name[0] != '\0' ? battery_name : "(none)",
+        num_chargers);
+    for (int i = 0; i < num_chargers; ++i) {
+        printf(" %s", chargers[i].name);
+    }
+    printf("\n");
+
+    if (watch_cb) {
+        start_watching();
+        for (int i = 0; i < POWER_SUPPLY_WATCH_COUNT; ++i) {
+            watch_cb((power_supply_watch_t)i);
+        }
+    }
+
+    return battery_name[0] != '\0' || num_chargers > 0;
+}
+
+
+/**
+ * Public functions
+ */
+
+bool power_supply_init(void) {
+    return scan();
+}
+
+void power_supply_handle_uevent(const char *action, const char *devpath) {
+    (void)devpath;
+
+    /* Changes of attributes are by far the most frequent uevents and keep the index valid */
+    if (strcmp(action, "add") == 0 || strcmp(action, "remove") == 0) {
+        scan();
+    }
+}
+
+bool power_supply_read_int(power_supply_attribute_t attribute, int64_t *value) {
+    char buffer[24];
+    if (!read_fd(battery_fds[attribute], buffer, sizeof(buffer))) {
+        return false;
+    }
+
+    *value = strtoll(buffer, NULL, 10);
+    return true;
+}
+
+bool power_supply_read_string(power_supply_attribute_t attribute, char *buffer, size_t size) {
+    return read_fd(battery_fds[attribute], buffer, size);
+}
+
+int power_supply_is_online(void) {
+    if (num_chargers == 0) {
+        char status[16];
+        if (!power_supply_read_string(POWER_SUPPLY_STATUS, status, sizeof(status))) {
+            return -1;
+        }
+        return strcmp(status, "Discharging") != 0;
+    }
+
+    bool is_readable = false;
+    for (int i = 0; i < num_chargers; ++i) {
+        char buffer[8];
+        if (read_fd(chargers[i].fd, buffer, sizeof(buffer))) {
+            is_readable = true;
+            if (atoi(buffer) > 0) {
+                return 1;
+            }
+        }
+    }
+
+    return is_readable ? 0 : -1;
+}
+
+bool power_supply_watch(power_supply_watch_cb_t cb) {
+    watch_cb = cb;
+    start_watching();
+
+    printf("Watching %d power supply attribute(s) for notifications\n", num_watched);
+    return num_watched > 0;
+}
+
+bool power_supply_is_watched(power_supply_watch_t watch) {
+    if (!is_group_registered[watch]) {
+        return false;
+    }
+
+    for (int i = 0; i < num_watched; ++i) {
+        if (watched[i].watch == watch && watched[i].is_required && !watched[i].has_notified) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void power_supply_log_stats(void) {
+    printf("Power supply notifications:");
+    for (int i = 0; i < POWER_SUPPLY_WATCH_COUNT; ++i) {
+        printf(" %s=%u (%s)", watch_names[i], num_notifications[i],
+            power_supply_is_watched((power_supply_watch_t)i) ? "watched" : "polled");
+    }
+    printf("\n");
+}
@@ -0,0 +1,123 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef POWER_SUPPLY_H
+#define POWER_SUPPLY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Maximum number of supplies that are watched for being online */
+#define POWER_SUPPLY_MAX_CHARGERS 8
+
+/* Attributes of the battery kept open in the index */
+typedef enum {
+    POWER_SUPPLY_CAPACITY = 0,
+    POWER_SUPPLY_STATUS,
+    POWER_SUPPLY_TEMP,
+    POWER_SUPPLY_CHARGE_NOW,
+    POWER_SUPPLY_CHARGE_FULL,
+    POWER_SUPPLY_CURRENT_NOW,
+    POWER_SUPPLY_ATTRIBUTE_COUNT
+} power_supply_attribute_t;
+
+/* Groups of attributes that are watched for kernel notifications */
+typedef enum {
+    /* The chargers' online attributes */
+    POWER_SUPPLY_WATCH_ONLINE = 0,
+    /* The battery's capacity and status */
+    POWER_SUPPLY_WATCH_BATTERY,
+    POWER_SUPPLY_WATCH_COUNT
+} power_supply_watch_t;
+
+/* Callback for a notification on a watched attribute or a change of the watched attributes */
+typedef void (*power_supply_watch_cb_t)(power_supply_watch_t watch);
+
+/**
+ * Scan /sys/class/power_supply and build the index of the battery and the chargers. Supplies are
+ * classified by their type and scope, supplies powered by the device (e.g. a stylus) are ignored.
+ *
+ * @return true if a battery or a charger was found, false otherwise
+ */
+bool power_supply_init(void);
+
+/**
+ * Rescan the supplies if one was added or removed. Other uevents leave the index alone.
+ *
+ * @param action uevent action
+ * @param devpath path of the device in sysfs
+ */
+void power_supply_handle_uevent(const char *action, const char *devpath);
+
+/**
+ * Read a numeric attribute of the battery.
+ *
+ * @param attribute attribute to read
+ * @param value pointer to write the value into
+ * @return true on success, false if the battery doesn't provide the attribute
+ */
+bool power_supply_read_int(power_supply_attribute_t attribute, int64_t *value);
+
+/**
+ * Read a string attribute of the battery without the trailing newline.
+ *
+ * @param attribute attribute to read
+ * @param buffer buffer to write the value into
+ * @param size size of the buffer
+ * @return true on success, false if the battery doesn't provide the attribute
+ */
+bool power_supply_read_string(power_supply_attribute_t attribute, char *buffer, size_t size);
+
+/**
+ * Check whether any charger is online. Without chargers in the index, the battery not discharging
+ * counts as online.
+ *
+ * @return 1 if online, 0 if offline or -1 if the state is unknown
+ */
+int power_supply_is_online(void);
+
+/**
+ * Watch the index's attributes for sysfs_notify() with POLLPRI on the event loop. An attribute is
+ * only re-read when the kernel signals a change. Attributes are watched again after every rescan
+ * and the callback is invoked for all groups then. Requires event_loop_init to have been called.
+ *
+ * @param cb callback to invoke when a watched attribute changed
+ * @return true if at least one attribute is watched, false otherwise
+ */
+bool power_supply_watch(power_supply_watch_cb_t cb);
+
+/**
+ * Check whether changes of a group are watched. Registration succeeds for any sysfs attribute,
+ * whether its driver calls sysfs_notify() or not. A group therefore only counts as watched once
+ * every attribute that decides its state was notified at least once, and until one of them fails
+ * to read. Until then the group must be polled.
+ *
+ * @param watch group to check
+ * @return true if changes of the group are notified, false if the group must be polled
+ */
+bool power_supply_is_watched(power_supply_watch_t watch);
+
+/**
+ * Print the number of notifications per group.
+ */
+void power_supply_log_stats(void);
+
+#endif /* POWER_SUPPLY_H */
@@ -0,0 +1,251 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "refresh_governor.h"
+
+#include "trace.h"
+
+#include "lv_drv_conf.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <linux/fb.h>
+
+#include <sys/ioctl.h>
+
+
+/**
+ * Static variables
+ */
+
+typedef enum {
+    /* Timer paused until something is invalidated */
+    REFRESH_GOVERNOR_PARKED,
+    /* Running at the policy's rate */
+    REFRESH_GOVERNOR_FULL,
+    /* Running at the low rate */
+    REFRESH_GOVERNOR_CLAMPED,
+    REFRESH_GOVERNOR_COUNT
+} refresh_governor_state_t;
+
+static const char *state_names[REFRESH_GOVERNOR_COUNT] = { "parked", "full", "clamped" };
+
+static lv_disp_t *governed_disp = NULL;
+static lv_timer_t *refr_timer = NULL;
+static lv_timer_cb_t original_refr_timer_cb = NULL;
+
+static refresh_governor_policy current_policy;
+static uint32_t full_period_ms = 1000 / REFRESH_GOVERNOR_DEFAULT_RATE;
+static uint32_t low_period_ms = 1000 / REFRESH_GOVERNOR_DEFAULT_RATE;
+static bool is_dimmed = false;
+static bool is_hot = false;
+
+static refresh_governor_state_t state = REFRESH_GOVERNOR_FULL;
+static int64_t state_since_us = 0;
+static int64_t time_in_state_us[REFRESH_GOVERNOR_COUNT] = { 0 };
+static uint32_t num_refreshes = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Detect the panel's refresh rate.
+ *
+ * @param backend backend driving the display
+ * @return rate in Hz
+ */
+static uint32_t detect_panel_rate(backends_backend_id_t backend);
+
+/**
+ * Switch to a new state and account the time spent in the previous one.
+ *
+ * @param new_state state to switch to
+ */
+static void set_state(refresh_governor_state_t new_state);
+
+/**
+ * Apply the period for the current clamping while the timer runs.
+ */
+static void update_period(void);
+
+/**
+ * Refresh the display and decide whether the timer keeps running.
+ *
+ * @param timer refresh timer
+ */
+static void governed_refr_timer_cb(lv_timer_t *timer);
+
+
+/**
+ * Static functions
+ */
+
+static uint32_t detect_panel_rate(backends_backend_id_t backend) {
+#if USE_FBDEV
+    if (backend != BACKENDS_BACKEND_FBDEV) {
+        return REFRESH_GOVERNOR_DEFAULT_RATE;
+    }
+
+    int fd = open(FBDEV_PATH, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return REFRESH_GOVERNOR_DEFAULT_RATE;
+    }
+
+    struct fb_var_screeninfo vinfo;
+    int ret = ioctl(fd, FBIOGET_VSCREENINFO, &vinfo);
+    close(fd);
+    if (ret != 0 || vinfo.pixclock == 0) {
+        return REFRESH_GOVERNOR_DEFAULT_RATE;
+    }
+
+    /* The pixel clock is given in picoseconds per pixel, blanking intervals included */
+    uint64_t htotal = (uint64_t)vinfo.xres + vinfo.left_margin + vinfo.right_margin + vinfo.hsync_len;
+    uint64_t vtotal = (uint64_t)vinfo.yres + vinfo.upper_margin + vinfo.lower_margin + vinfo.vsync_len;
+    uint64_t rate = 1000000000000ULL / ((uint64_t)vinfo.pixclock * htotal * vtotal);
+    return rate >= 1 && rate <= 240 ? (uint32_t)rate : REFRESH_GOVERNOR_DEFAULT_RATE;
+#else
+    LV_UNUSED(backend);
+    return REFRESH_GOVERNOR_DEFAULT_RATE;
+#endif /* USE_FBDEV */
+}
+
+static void set_state(refresh_governor_state_t new_state) {
+    if (new_state == state) {
+        return;
+    }
+
+    int64_t now_us = trace_now_us();
+    time_in_state_us[state] += now_us - state_since_us;
+    state = new_state;
+    state_since_us = now_us;
+}
+
+static void update_period(void) {
+    bool is_clamped = is_dimmed || is_hot;
+    lv_timer_set_period(refr_timer, is_clamped ? low_period_ms : full_period_ms);
+
+    if (state != REFRESH_GOVERNOR_PARKED) {
+        set_state(is_clamped ? REFRESH_GOVERNOR_CLAMPED : REFRESH_GOVERNOR_FULL);
+    }
+}
+
+static void governed_refr_timer_cb(lv_timer_t *timer) {
+    if (state == REFRESH_GOVERNOR_PARKED) {
+        /* Woken by an invalidation */
+        set_state(REFRESH_GOVERNOR_FULL);
+        update_period();
+    }
+
+    original_refr_timer_cb(timer);
+    ++num_refreshes;
+
+    /* Animations only invalidate when their timer runs, keep refreshing until they are done */
+    if (lv_anim_count_running() == 0 && governed_disp->inv_p == 0) {
+        lv_timer_pause(timer);
+        set_state(REFRESH_GOVERNOR_PARKED);
+    }
+}
+
+
+/**
+ * Public functions
+ */
+
+void refresh_governor_init(lv_disp_t *disp, backends_backend_id_t backend, const refresh_governor_policy *policy) {
+    current_policy = *policy;
+    governed_disp = disp;
+
+    uint32_t panel_rate = detect_panel_rate(backend);
+    uint32_t full_rate = current_policy.rate > 0 ? LV_MIN(current_policy.rate, panel_rate) : panel_rate;
+    uint32_t low_rate = current_policy.low_rate > 0 ? LV_MIN(current_policy.low_rate, full_rate) : full_rate;
+    full_period_ms = 1000 / full_rate;
+    low_period_ms = 1000 / low_rate;
+
+    refr_timer = _lv_disp_get_refr_timer(disp);
+    original_refr_timer_cb = refr_timer->timer_cb;
+    refr_timer->timer_cb = governed_refr_timer_cb;
+
+    state_since_us = trace_now_us();
+    update_period();
+
+    printf("Refreshing at up to %u Hz (panel %u Hz, clamped %u Hz)\n", full_rate, panel_rate, low_rate);
+}
+
+uint32_t refresh_governor_get_timeout(uint32_t time_till_next) {
+    if (state != REFRESH_GOVERNOR_PARKED || governed_disp->inv_p == 0) {
+        return time_till_next;
+    }
+
+    /* Not every LVGL version resumes the refresh timer on invalidation */
+    lv_timer_resume(refr_timer);
+    lv_timer_ready(refr_timer);
+    return 0;
+}
+
+void refresh_governor_set_dimmed(bool dimmed) {
+    if (dimmed == is_dimmed) {
+        return;
+    }
+
+    is_dimmed = dimmed;
+    if (refr_timer != NULL) {
+        update_period();
+    }
+}
+
+void refresh_governor_set_temperature(int deci_celsius) {
+    bool hot = current_policy.hot_temperature > 0 && deci_celsius >= current_policy.hot_temperature * 10;
+    if (hot == is_hot) {
+        return;
+    }
+
+    is_hot = hot;
+    if (refr_timer == NULL) {
+        return;
+    }
+
+    printf("Battery %s, refreshing at up to %u Hz\n", is_hot ? "hot" : "cooled down",
+        1000 / (is_hot || is_dimmed ? low_period_ms : full_period_ms));
+    update_period();
+}
+
+void refresh_governor_log_stats(void) {
+    if (refr_timer == NULL) {
+        return;
+    }
+
+    int64_t current_us = trace_now_us() - state_since_us;
+    int64_t total_us = current_us;
+    for (int i = 0; i < REFRESH_GOVERNOR_COUNT; ++i) {
+        total_us += time_in_state_us[i];
+    }
+
+    printf("Refresh %s at %u Hz (%u refreshes):", state_names[state], 1000 / refr_timer->period, num_refreshes);
+    for (int i = 0; i < REFRESH_GOVERNOR_COUNT; ++i) {
+        int64_t state_us = time_in_state_us[i] + (i == (int)state ? current_us : 0);
+        int64_t permille = total_us > 0 ? state_us * 1000 / total_us : 0;
+        printf(" %s=%lld.%01lld%%", state_names[i], (long long)(permille / 10), (long long)(permille % 10));
+    }
+    printf("\n");
+}
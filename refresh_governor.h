@@ -0,0 +1,84 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef REFRESH_GOVERNOR_H
+#define REFRESH_GOVERNOR_H
+
+#include "backends.h"
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Panel rate assumed if it can't be detected */
+#define REFRESH_GOVERNOR_DEFAULT_RATE 60
+
+/**
+ * Refresh rate policy, all rates are in Hz
+ */
+typedef struct {
+    /* Rate while something is animating, 0 to use the panel's rate */
+    uint8_t rate;
+    /* Rate the refresh is clamped to while the display is dimmed or the battery is hot */
+    uint8_t low_rate;
+    /* Battery temperature (in degrees Celsius) at or above which the rate is clamped, 0 to disable */
+    uint8_t hot_temperature;
+} refresh_governor_policy;
+
+/**
+ * Take over the period of the display's refresh timer. The timer is parked after every refresh
+ * that leaves nothing animating and runs at the policy's rate otherwise.
+ *
+ * @param disp display to govern
+ * @param backend backend driving the display, used to detect the panel's rate
+ * @param policy rate policy to apply
+ */
+void refresh_governor_init(lv_disp_t *disp, backends_backend_id_t backend, const refresh_governor_policy *policy);
+
+/**
+ * Wake the refresh timer if something was invalidated while it was parked. Call after
+ * lv_timer_handler.
+ *
+ * @param time_till_next value returned by lv_timer_handler
+ * @return time until LVGL needs to run again, 0 if the refresh timer was woken
+ */
+uint32_t refresh_governor_get_timeout(uint32_t time_till_next);
+
+/**
+ * Clamp the rate while the display is dimmed.
+ *
+ * @param is_dimmed true if the display is dimmed
+ */
+void refresh_governor_set_dimmed(bool is_dimmed);
+
+/**
+ * Clamp the rate while the battery is hot.
+ *
+ * @param deci_celsius battery temperature in tenths of a degree Celsius
+ */
+void refresh_governor_set_temperature(int deci_celsius);
+
+/**
+ * Print the current rate and the share of time spent at each rate.
+ */
+void refresh_governor_log_stats(void);
+
+#endif /* REFRESH_GOVERNOR_H */
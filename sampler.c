@@ -0,0 +1,296 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "sampler.h"
+
+#include "event_loop.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+
+/**
+ * Static variables
+ */
+
+/* A channel is sampled early if it is due within this fraction of its interval, 1/n, and no later
+   than the shortest interval of any channel, when the next wakeup would take it along anyway */
+#define EARLY_FRACTION 4
+
+typedef struct {
+    sampler_cb_t cb;
+    uint32_t min_interval_ms;
+    uint32_t max_interval_ms;
+    uint32_t interval_ms;
+    /* CLOCK_MONOTONIC time of the next sample */
+    int64_t due_ms;
+    uint32_t num_samples;
+    uint32_t num_changes;
+    bool is_enabled;
+    /* If true, the channel is only sampled at its maximum interval */
+    bool is_relaxed;
+} sampled_channel;
+
+static const char *channel_names[SAMPLER_CHANNEL_COUNT] = { "online", "battery" };
+
+static sampled_channel channels[SAMPLER_CHANNEL_COUNT];
+static int timer_fd = -1;
+static int64_t start_ms = 0;
+static uint32_t num_wakeups = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Get the current CLOCK_MONOTONIC time.
+ *
+ * @return time in milliseconds
+ */
+static int64_t now_ms(void);
+
+/**
+ * Arm the timer for the enabled channel that is due first, disarm it if all channels are paused.
+ */
+static void arm_timer(void);
+
+/**
+ * Sample a channel and schedule its next sample.
+ *
+ * @param c channel to sample
+ * @param now current time in milliseconds
+ */
+static void sample_channel(sampled_channel *c, int64_t now);
+
+/**
+ * Get how long before it is due a channel is sampled along with another one.
+ *
+ * @param c channel to check
+ * @return time in milliseconds
+ */
+static uint32_t get_early_window_ms(const sampled_channel *c);
+
+/**
+ * Sample all channels that are due.
+ *
+ * @param fd timer file descriptor
+ * @param events is unused
+ * @param user_data is unused
+ */
+static void handle_timer(int fd, uint32_t events, void *user_data);
+
+
+/**
+ * Static functions
+ */
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void arm_timer(void) {
+    if (timer_fd < 0) {
+        return;
+    }
+
+    int64_t due_ms = -1;
+    for (int i = 0; i < SAMPLER_CHANNEL_COUNT; ++i) {
+        if (channels[i].is_enabled && (due_ms < 0 || channels[i].due_ms < due_ms)) {
+            due_ms = channels[i].due_ms;
+        }
+    }
+
+    struct itimerspec spec = { 0 };
+    if (due_ms >= 0) {
+        spec.it_value = (struct timespec){ .tv_sec = due_ms / 1000, .tv_nsec = (due_ms % 1000) * 1000000 };
+    }
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+}
+
+static void sample_channel(sampled_channel *c, int64_t now) {
+    ++c->num_samples;
+    if (c->is_relaxed) {
+        c->cb();
+        c->interval_ms = c->max_interval_ms;
+    } else if (c->cb()) {
+        ++c->num_changes;
+        c->interval_ms = c->min_interval_ms;
+    } else if (c->interval_ms < c->max_interval_ms) {
+        c->interval_ms = c->interval_ms * 2 < c->max_interval_ms ? c->interval_ms * 2 : c->max_interval_ms;
+    }
+    c->due_ms = now + c->interval_ms;
+}
+
+static uint32_t get_early_window_ms(const sampled_channel *c) {
+    uint32_t window_ms = c->interval_ms / EARLY_FRACTION;
+    for (int i = 0; i < SAMPLER_CHANNEL_COUNT; ++i) {
+        if (channels[i].is_enabled && channels[i].interval_ms < window_ms) {
+            window_ms = channels[i].interval_ms;
+        }
+    }
+    return window_ms;
+}
+
+static void handle_timer(int fd, uint32_t events, void *user_data) {
+    (void)events;
+    (void)user_data;
+
+    uint64_t expirations;
+    if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return;
+    }
+    ++num_wakeups;
+
+    /* Take channels that are almost due along instead of waking up again shortly after */
+    int64_t now = now_ms();
+    for (int i = 0; i < SAMPLER_CHANNEL_COUNT; ++i) {
+        if (channels[i].is_enabled && channels[i].due_ms - get_early_window_ms(&channels[i]) <= now) {
+            sample_channel(&channels[i], now);
+        }
+    }
+
+    arm_timer();
+}
+
+
+/**
+ * Public functions
+ */
+
+bool sampler_init(const sampler_policy *policy, sampler_cb_t online_cb, sampler_cb_t battery_cb) {
+    channels[SAMPLER_CHANNEL_ONLINE] = (sampled_channel){ .cb = online_cb,
+        .min_interval_ms = policy->online_min_interval, .max_interval_ms = policy->online_max_interval };
+    channels[SAMPLER_CHANNEL_BATTERY] = (sampled_channel){ .cb = battery_cb,
+        .min_interval_ms = policy->battery_min_interval, .max_interval_ms = policy->battery_max_interval };
+
+    start_ms = now_ms();
+    for (int i = 0; i < SAMPLER_CHANNEL_COUNT; ++i) {
+        sampled_channel *c = &channels[i];
+        if (c->min_interval_ms == 0) {
+            c->min_interval_ms = 1;
+        }
+        if (c->max_interval_ms < c->min_interval_ms) {
+            c->max_interval_ms = c->min_interval_ms;
+        }
+        c->interval_ms = c->min_interval_ms;
+        c->due_ms = start_ms + c->interval_ms;
+        c->is_enabled = true;
+    }
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd < 0) {
+        perror("Failed to create sampling timer");
+        return false;
+    }
+
+    if (!event_loop_add_fd(timer_fd, EPOLLIN, handle_timer, NULL)) {
+        close(timer_fd);
+        timer_fd = -1;
+        return false;
+    }
+
+    arm_timer();
+    return true;
+}
+
+void sampler_speed_up(sampler_channel_t channel) {
+    if (timer_fd < 0 || !channels[channel].is_enabled) {
+        return;
+    }
+
+    int64_t due_ms = now_ms() + channels[channel].min_interval_ms;
+    channels[channel].interval_ms = channels[channel].min_interval_ms;
+    if (due_ms < channels[channel].due_ms) {
+        channels[channel].due_ms = due_ms;
+        arm_timer();
+    }
+}
+
+void sampler_set_enabled(sampler_channel_t channel, bool is_enabled) {
+    sampled_channel *c = &channels[channel];
+    if (timer_fd < 0 || c->is_enabled == is_enabled) {
+        return;
+    }
+
+    c->is_enabled = is_enabled;
+    if (is_enabled) {
+        c->interval_ms = c->min_interval_ms;
+        c->due_ms = now_ms() + c->interval_ms;
+    }
+    printf("Sampling of %s %s\n", channel_names[channel], is_enabled ? "resumed" : "paused");
+
+    arm_timer();
+}
+
+void sampler_set_relaxed(sampler_channel_t channel, bool is_relaxed) {
+    sampled_channel *c = &channels[channel];
+    if (timer_fd < 0 || c->is_relaxed == is_relaxed) {
+        return;
+    }
+
+    c->is_relaxed = is_relaxed;
+    c->interval_ms = is_relaxed ? c->max_interval_ms : c->min_interval_ms;
+    c->due_ms = now_ms() + c->interval_ms;
+    printf("Sampling of %s %s\n", channel_names[channel], is_relaxed ? "relaxed" : "tightened");
+
+    arm_timer();
+}
+
+void sampler_stop(void) {
+    if (timer_fd < 0) {
+        return;
+    }
+
+    event_loop_remove_fd(timer_fd);
+    close(timer_fd);
+    timer_fd = -1;
+}
+
+void sampler_log_stats(void) {
+    if (start_ms == 0) {
+        return;
+    }
+
+    int64_t elapsed_ms = now_ms() - start_ms;
+    if (elapsed_ms <= 0) {
+        elapsed_ms = 1;
+    }
+
+    printf("Sampling: %u wakeups in %llds", num_wakeups, (long long)(elapsed_ms / 1000));
+    for (int i = 0; i < SAMPLER_CHANNEL_COUNT; ++i) {
+        const sampled_channel *c = &channels[i];
+        uint32_t centi_rate = (uint32_t)((int64_t)c->num_samples * 100000 / elapsed_ms);
+        printf(", %s %u samples (%u.%02u/s, %u changes, ", channel_names[i], c->num_samples, centi_rate / 100,
+            centi_rate % 100, c->num_changes);
+        if (c->is_enabled) {
+            printf("interval %ums)", c->interval_ms);
+        } else {
+            printf("paused)");
+        }
+    }
+    printf("\n");
+}
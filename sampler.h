@@ -0,0 +1,102 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Things that are sampled, each at its own interval */
+typedef enum {
+    /* Whether a charger is online */
+    SAMPLER_CHANNEL_ONLINE = 0,
+    /* Capacity, status and temperature of the battery */
+    SAMPLER_CHANNEL_BATTERY,
+    SAMPLER_CHANNEL_COUNT
+} sampler_channel_t;
+
+/* Callback sampling a channel, returns true if the reading changed */
+typedef bool (*sampler_cb_t)(void);
+
+/**
+ * Sampling policy, all intervals are in milliseconds. A channel is sampled at its minimum
+ * interval after a change and the interval doubles with every unchanged reading up to the maximum.
+ */
+typedef struct {
+    /* Fastest interval for the online state */
+    uint32_t online_min_interval;
+    /* Slowest interval for the online state */
+    uint32_t online_max_interval;
+    /* Fastest interval for the battery */
+    uint32_t battery_min_interval;
+    /* Slowest interval for the battery */
+    uint32_t battery_max_interval;
+} sampler_policy;
+
+/**
+ * Start sampling on a single timer of the event loop. Channels that are due close to each other
+ * are sampled in the same wakeup. Requires event_loop_init to have been called.
+ *
+ * @param policy intervals to apply
+ * @param online_cb callback sampling the online state
+ * @param battery_cb callback sampling the battery
+ * @return true on success, false otherwise
+ */
+bool sampler_init(const sampler_policy *policy, sampler_cb_t online_cb, sampler_cb_t battery_cb);
+
+/**
+ * Drop a channel back to its minimum interval, e.g. on user activity or when a uevent hints at a
+ * change. Does nothing if sampling isn't running.
+ *
+ * @param channel channel to speed up
+ */
+void sampler_speed_up(sampler_channel_t channel);
+
+/**
+ * Pause or resume a channel, e.g. while the kernel notifies its changes. A resumed channel starts
+ * at its minimum interval. Does nothing if sampling isn't running.
+ *
+ * @param channel channel to pause or resume
+ * @param is_enabled false to pause the channel, true to resume it
+ */
+void sampler_set_enabled(sampler_channel_t channel, bool is_enabled);
+
+/**
+ * Only sample a channel at its maximum interval, e.g. as a safety net while the kernel notifies
+ * its changes. A tightened channel starts at its minimum interval again. Does nothing if sampling
+ * isn't running.
+ *
+ * @param channel channel to relax or tighten
+ * @param is_relaxed true to relax the channel, false to tighten it
+ */
+void sampler_set_relaxed(sampler_channel_t channel, bool is_relaxed);
+
+/**
+ * Stop sampling and release the timer.
+ */
+void sampler_stop(void);
+
+/**
+ * Print the number of wakeups and the effective sample rate of each channel.
+ */
+void sampler_log_stats(void);
+
+#endif /* SAMPLER_H */
@@ -0,0 +1,178 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "shutdown.h"
+
+#include "event_loop.h"
+#include "trace.h"
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+
+
+/**
+ * Static variables
+ */
+
+static shutdown_step_cb_t steps[SHUTDOWN_STAGE_COUNT] = { NULL };
+static shutdown_stats_cb_t dump_stats = NULL;
+
+/* Additional signals and their callbacks */
+typedef struct {
+    int signo;
+    shutdown_signal_cb_t cb;
+} signal_handler;
+
+static signal_handler extra_signals[SHUTDOWN_MAX_SIGNALS];
+static int num_extra_signals = 0;
+
+static sigset_t handled_signals;
+static bool are_signals_blocked = false;
+static int signal_fd = -1;
+static bool has_torn_down = false;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Read and handle pending signals.
+ *
+ * @param fd signalfd
+ * @param events is unused
+ * @param user_data is unused
+ */
+static void handle_signals(int fd, uint32_t events, void *user_data);
+
+
+/**
+ * Static functions
+ */
+
+static void handle_signals(int fd, uint32_t events, void *user_data) {
+    (void)events;
+    (void)user_data;
+
+    struct signalfd_siginfo info;
+    while (read(fd, &info, sizeof(info)) == sizeof(info)) {
+        bool is_extra = false;
+        for (int i = 0; i < num_extra_signals; ++i) {
+            if (extra_signals[i].signo == (int)info.ssi_signo) {
+                extra_signals[i].cb(extra_signals[i].signo);
+                is_extra = true;
+            }
+        }
+
+        if (is_extra) {
+            continue;
+        } else if (info.ssi_signo == SIGUSR1) {
+            if (dump_stats) {
+                dump_stats();
+            }
+        } else {
+            shutdown_exit(EXIT_SUCCESS, info.ssi_signo == SIGINT ? "Interrupted" : "Terminated");
+        }
+    }
+}
+
+
+/**
+ * Public functions
+ */
+
+void shutdown_add_signal(int signo, shutdown_signal_cb_t cb) {
+    if (num_extra_signals >= SHUTDOWN_MAX_SIGNALS) {
+        printf("Cannot handle signal %d\n", signo);
+        return;
+    }
+
+    extra_signals[num_extra_signals].signo = signo;
+    extra_signals[num_extra_signals].cb = cb;
+    ++num_extra_signals;
+}
+
+void shutdown_init(shutdown_stats_cb_t stats_cb) {
+    dump_stats = stats_cb;
+
+    sigemptyset(&handled_signals);
+    sigaddset(&handled_signals, SIGINT);
+    sigaddset(&handled_signals, SIGTERM);
+    sigaddset(&handled_signals, SIGUSR1);
+    for (int i = 0; i < num_extra_signals; ++i) {
+        sigaddset(&handled_signals, extra_signals[i].signo);
+    }
+
+    if (sigprocmask(SIG_BLOCK, &handled_signals, NULL) != 0) {
+        perror("Failed to block signals");
+        return;
+    }
+    are_signals_blocked = true;
+
+    signal_fd = signalfd(-1, &handled_signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd < 0) {
+        perror("Failed to create signalfd");
+        return;
+    }
+
+    if (!event_loop_add_fd(signal_fd, EPOLLIN, handle_signals, NULL)) {
+        close(signal_fd);
+        signal_fd = -1;
+    }
+}
+
+void shutdown_register(shutdown_stage_t stage, shutdown_step_cb_t cb) {
+    steps[stage] = cb;
+}
+
+void shutdown_teardown(void) {
+    if (has_torn_down) {
+        return;
+    }
+    has_torn_down = true;
+
+    int64_t start_us = trace_now_us();
+    for (int i = 0; i < SHUTDOWN_STAGE_COUNT; ++i) {
+        if (steps[i]) {
+            steps[i]();
+        }
+    }
+
+    /* Don't leave the signals blocked for anything exec'd after the teardown */
+    if (are_signals_blocked) {
+        sigprocmask(SIG_UNBLOCK, &handled_signals, NULL);
+        are_signals_blocked = false;
+    }
+
+    int64_t duration_us = trace_now_us() - start_us;
+    printf("Teardown took %lld.%01lldms\n", (long long)(duration_us / 1000), (long long)((duration_us % 1000) / 100));
+}
+
+void shutdown_exit(int status, const char *reason) {
+    printf("%s, exiting\n", reason);
+    shutdown_teardown();
+    exit(status);
+}
@@ -0,0 +1,91 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SHUTDOWN_H
+#define SHUTDOWN_H
+
+/**
+ * Teardown stages, run in this order
+ */
+typedef enum {
+    /* Stop reading sensors so that nothing reacts to the teardown itself */
+    SHUTDOWN_STAGE_SAMPLING,
+    /* Restore the backlight and unblank the panel */
+    SHUTDOWN_STAGE_BACKLIGHT,
+    /* Restore the terminal's display and keyboard mode */
+    SHUTDOWN_STAGE_TERMINAL,
+    /* Release the framebuffer or DRM device */
+    SHUTDOWN_STAGE_DISPLAY,
+    SHUTDOWN_STAGE_COUNT
+} shutdown_stage_t;
+
+/* Teardown step of a single stage */
+typedef void (*shutdown_step_cb_t)(void);
+
+/* Callback for dumping live statistics */
+typedef void (*shutdown_stats_cb_t)(void);
+
+/* Callback for an additional signal received through the signalfd */
+typedef void (*shutdown_signal_cb_t)(int signo);
+
+/* Maximum number of additional signals */
+#define SHUTDOWN_MAX_SIGNALS 4
+
+/**
+ * Receive an additional signal through the signalfd. Must be called before shutdown_init.
+ *
+ * @param signo signal number
+ * @param cb callback to invoke when the signal arrives
+ */
+void shutdown_add_signal(int signo, shutdown_signal_cb_t cb);
+
+/**
+ * Block SIGINT, SIGTERM, SIGUSR1 and any additional signals and receive them through a signalfd on
+ * the event loop instead.
+ * Must be called before any threads are created so that they inherit the signal mask. Requires
+ * event_loop_init to have been called.
+ *
+ * @param stats_cb callback to invoke on SIGUSR1
+ */
+void shutdown_init(shutdown_stats_cb_t stats_cb);
+
+/**
+ * Register the teardown step of a stage, replacing any previously registered step.
+ *
+ * @param stage stage to register the step for
+ * @param cb step to run
+ */
+void shutdown_register(shutdown_stage_t stage, shutdown_step_cb_t cb);
+
+/**
+ * Run all registered teardown steps in order and restore the signal mask. Runs only once, later
+ * calls return immediately.
+ */
+void shutdown_teardown(void);
+
+/**
+ * Tear down and exit.
+ *
+ * @param status exit status
+ * @param reason reason to log
+ */
+void shutdown_exit(int status, const char *reason);
+
+#endif /* SHUTDOWN_H */
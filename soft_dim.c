@@ -0,0 +1,221 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "soft_dim.h"
+
+#include "trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+/**
+ * Static variables
+ */
+
+static bool is_enabled = false;
+static void (*original_flush_cb)(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) = NULL;
+
+/* Channel multiplier in 1/256 units per brightness percentage, 256 * (pct / 100)^(1 / 2.2). Undoing
+ * the display gamma makes a percentage look like the same backlight level. */
+static const uint16_t pct_scales[101] = {
+    0, 32, 43, 52, 59, 66, 71, 76, 81, 86, 90, 94, 98,
+    101, 105, 108, 111, 114, 117, 120, 123, 126, 129, 131, 134, 136,
+    139, 141, 144, 146, 148, 150, 153, 155, 157, 159, 161, 163, 165,
+    167, 169, 171, 173, 174, 176, 178, 180, 182, 183, 185, 187, 189,
+    190, 192, 193, 195, 197, 198, 200, 201, 203, 204, 206, 208, 209,
+    210, 212, 213, 215, 216, 218, 219, 220, 222, 223, 225, 226, 227,
+    229, 230, 231, 233, 234, 235, 236, 238, 239, 240, 242, 243, 244,
+    245, 246, 248, 249, 250, 251, 252, 254, 255, 256
+};
+
+static uint8_t level_pct = 100;
+static uint16_t level_scale = 256;
+
+/* Output for buffers that don't belong to LVGL, kept outside of LVGL's heap and grown on demand */
+static lv_color_t *scratch = NULL;
+static uint32_t scratch_size = 0;
+
+static uint64_t dimmed_pixels = 0;
+static int64_t dimming_time_us = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Dim a flushed area and forward it to the display driver.
+ *
+ * @param disp_drv display driver
+ * @param area area to flush
+ * @param color_p pixels to flush
+ */
+static void dimming_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+
+/**
+ * Check whether pixels are part of one of the display's draw buffers.
+ *
+ * @param disp_drv display driver
+ * @param color_p pixels to check
+ * @return true if LVGL renders into the pixels, false otherwise
+ */
+static bool is_draw_buffer(lv_disp_drv_t *disp_drv, const lv_color_t *color_p);
+
+/**
+ * Get a scratch buffer of at least a given size.
+ *
+ * @param count number of pixels
+ * @return scratch buffer or NULL if it could not be allocated
+ */
+static lv_color_t *get_scratch(uint32_t count);
+
+
+/**
+ * Static functions
+ */
+
+static void dimming_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
+    if (level_scale < 256) {
+        uint32_t count = lv_area_get_size(area);
+        int64_t start_us = trace_now_us();
+
+        /* LVGL renders the next area from scratch, its own buffers can be modified in place. Other
+         * buffers such as the cached frame must survive the flush. */
+        lv_color_t *dimmed = is_draw_buffer(disp_drv, color_p) ? color_p : get_scratch(count);
+        if (dimmed == NULL) {
+            original_flush_cb(disp_drv, area, color_p);
+            return;
+        }
+        soft_dim_apply(color_p, dimmed, count, level_scale);
+
+        dimming_time_us += trace_now_us() - start_us;
+        dimmed_pixels += count;
+        color_p = dimmed;
+    }
+
+    original_flush_cb(disp_drv, area, color_p);
+}
+
+static bool is_draw_buffer(lv_disp_drv_t *disp_drv, const lv_color_t *color_p) {
+    lv_disp_draw_buf_t *draw_buf = disp_drv->draw_buf;
+    const lv_color_t *bufs[] = { draw_buf->buf1, draw_buf->buf2 };
+
+    for (size_t i = 0; i < sizeof(bufs) / sizeof(bufs[0]); ++i) {
+        if (bufs[i] != NULL && color_p >= bufs[i] && color_p < bufs[i] + draw_buf->size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static lv_color_t *get_scratch(uint32_t count) {
+    if (count > scratch_size) {
+        lv_color_t *grown = realloc(scratch, (size_t)count * sizeof(lv_color_t));
+        if (grown == NULL) {
+            printf("Failed to allocate dimming buffer, flushing undimmed\n");
+            return NULL;
+        }
+        scratch = grown;
+        scratch_size = count;
+    }
+    return scratch;
+}
+
+
+
+/**
+ * Public functions
+ */
+
+void soft_dim_init(lv_disp_t *disp, uint8_t pct) {
+    original_flush_cb = disp->driver->flush_cb;
+    disp->driver->flush_cb = dimming_flush_cb;
+    is_enabled = true;
+
+    soft_dim_set_level(pct);
+    printf("No backlight control, dimming in software\n");
+}
+
+void soft_dim_set_level(uint8_t pct) {
+    if (!is_enabled || pct == level_pct) {
+        return;
+    }
+
+    level_pct = pct;
+    level_scale = pct_scales[LV_MIN(pct, 100)];
+    lv_obj_invalidate(lv_scr_act());
+}
+
+void soft_dim_apply(const lv_color_t *src, lv_color_t *dst, uint32_t count, uint16_t scale) {
+    const uint32_t *s = (const uint32_t *)src;
+    uint32_t *d = (uint32_t *)dst;
+    uint32_t i = 0;
+
+#if defined(__ARM_NEON)
+    /* Widening multiply, then keep the high byte. The alpha lanes are taken from the input. */
+    uint8x8_t factor = vdup_n_u8((uint8_t)LV_MIN(scale, 255));
+    uint8x16_t alpha_mask = vreinterpretq_u8_u32(vdupq_n_u32(0xFF000000));
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t in = vld1q_u8((const uint8_t *)(s + i));
+        uint8x8_t lo = vshrn_n_u16(vmull_u8(vget_low_u8(in), factor), 8);
+        uint8x8_t hi = vshrn_n_u16(vmull_u8(vget_high_u8(in), factor), 8);
+        vst1q_u8((uint8_t *)(d + i), vbslq_u8(alpha_mask, in, vcombine_u8(lo, hi)));
+    }
+#elif defined(__SSE2__)
+    /* Unpack to 16 bits, multiply, shift back and pack. The alpha bytes are taken from the input. */
+    __m128i zero = _mm_setzero_si128();
+    __m128i factor = _mm_set1_epi16((short)scale);
+    __m128i alpha_mask = _mm_set1_epi32((int)0xFF000000);
+    for (; i + 4 <= count; i += 4) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(in, zero), factor), 8);
+        __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(in, zero), factor), 8);
+        __m128i out = _mm_packus_epi16(lo, hi);
+        out = _mm_or_si128(_mm_and_si128(alpha_mask, in), _mm_andnot_si128(alpha_mask, out));
+        _mm_storeu_si128((__m128i *)(d + i), out);
+    }
+#endif
+
+    /* Two channels per multiply, the 8 bits between them absorb the carry */
+    for (; i < count; ++i) {
+        uint32_t rb = ((s[i] & 0x00FF00FF) * scale >> 8) & 0x00FF00FF;
+        uint32_t g = ((s[i] & 0x0000FF00) * scale >> 8) & 0x0000FF00;
+        d[i] = (s[i] & 0xFF000000) | rb | g;
+    }
+}
+
+void soft_dim_log_stats(void) {
+    if (!is_enabled) {
+        printf("Software dimming disabled\n");
+        return;
+    }
+
+    long long us_per_mpx = dimmed_pixels > 0 ? (long long)(dimming_time_us * 1000000 / (int64_t)dimmed_pixels) : 0;
+    printf("Software dimming at %u%%: %llu pixels dimmed, %lld us per megapixel\n", level_pct,
+        (unsigned long long)dimmed_pixels, us_per_mpx);
+}
@@ -0,0 +1,62 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SOFT_DIM_H
+#define SOFT_DIM_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Dim flushed pixels in software for panels without backlight control. Wraps the display's flush
+ * callback and must be installed before any other flush wrapper. LVGL's draw buffers are dimmed in
+ * place, any other buffer (e.g. a cached frame) is left untouched and dimmed into a scratch buffer.
+ *
+ * @param disp display to dim
+ * @param pct initial brightness in percent
+ */
+void soft_dim_init(lv_disp_t *disp, uint8_t pct);
+
+/**
+ * Change the brightness. Invalidates the whole screen if the level changed. A brightness of 0
+ * renders black, which is the only way to turn off panels that can't be powered down.
+ *
+ * @param pct brightness in percent
+ */
+void soft_dim_set_level(uint8_t pct);
+
+/**
+ * Scale the color channels of a run of pixels, leaving alpha untouched.
+ *
+ * @param src pixels to dim
+ * @param dst buffer to write the dimmed pixels into, may be src to dim in place
+ * @param count number of pixels
+ * @param scale channel multiplier in 1/256 units
+ */
+void soft_dim_apply(const lv_color_t *src, lv_color_t *dst, uint32_t count, uint16_t scale);
+
+/**
+ * Print the dimming cost per flushed megapixel.
+ */
+void soft_dim_log_stats(void);
+
+#endif /* SOFT_DIM_H */
@@ -0,0 +1,398 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "splash.h"
+
+#include "trace.h"
+
+#include "lv_drv_conf.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <linux/fb.h>
+
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+
+/**
+ * Static variables
+ */
+
+/* Battery geometry, keep in sync with the UI built in charger_ui.c */
+#define BATTERY_WIDTH 400
+#define BATTERY_HEIGHT 800
+#define BATTERY_BORDER 5
+#define BATTERY_RADIUS 60
+#define FILL_RADIUS 55
+#define FILL_HEIGHT_PER_PCT 8
+#define TIP_WIDTH 140
+#define TIP_HEIGHT 45
+#define TIP_Y 745
+#define TIP_BORDER 5
+#define TIP_RADIUS 30
+
+#define COLOR_BACKGROUND 0x000000
+#define COLOR_BORDER 0xFFFFFF
+
+/* Visible part of a mapped framebuffer */
+typedef struct {
+    uint8_t *pixels;
+    int width;
+    int height;
+    int line_length;
+    int bytes_per_pixel;
+} framebuffer;
+
+/* Splash colors packed into the pixel format of the target */
+typedef struct {
+    uint32_t background;
+    uint32_t border;
+    uint32_t fill;
+} palette;
+
+/* Clip rectangle, the end coordinates are exclusive */
+typedef struct {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+} clip_area;
+
+static int splash_capacity = -1;
+static int splash_fill_width_pct = 100;
+static uint32_t splash_fill_color = 0x00FF00;
+static int64_t shown_time_us = -1;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Convert a 24-bit RGB color into the framebuffer's pixel format.
+ *
+ * @param vinfo variable screen info of the framebuffer
+ * @param rgb color in 0xRRGGBB format
+ * @return pixel value
+ */
+static uint32_t pack_color(const struct fb_var_screeninfo *vinfo, uint32_t rgb);
+
+/**
+ * Compute the integer square root.
+ *
+ * @param value non-negative input
+ * @return largest integer whose square is not greater than value
+ */
+static int isqrt(int value);
+
+/**
+ * Compute how far a row of a rounded rectangle is inset on either side because of the corners.
+ *
+ * @param row row index relative to the top of the rectangle
+ * @param height height of the rectangle
+ * @param radius corner radius
+ * @return number of pixels to skip at both ends of the row
+ */
+static int get_corner_inset(int row, int height, int radius);
+
+/**
+ * Fill a horizontal span of pixels.
+ *
+ * @param fb framebuffer to draw into
+ * @param clip area to clip the span to
+ * @param y row of the span
+ * @param x0 first column of the span
+ * @param x1 column after the last one of the span
+ * @param color packed pixel value
+ */
+static void fill_span(const framebuffer *fb, const clip_area *clip, int y, int x0, int x1, uint32_t color);
+
+/**
+ * Draw a rounded rectangle, either filled or as an outline only.
+ *
+ * @param fb framebuffer to draw into
+ * @param clip area to clip the rectangle to
+ * @param x left edge of the rectangle
+ * @param y top edge of the rectangle
+ * @param w width of the rectangle
+ * @param h height of the rectangle
+ * @param radius corner radius
+ * @param border width of the outline or 0 to fill the rectangle
+ * @param color packed pixel value
+ */
+static void draw_rounded_rect(const framebuffer *fb, const clip_area *clip, int x, int y, int w, int h, int radius,
+    int border, uint32_t color);
+
+/**
+ * Draw the battery into the framebuffer.
+ *
+ * @param fb framebuffer to draw into
+ * @param colors colors in the framebuffer's pixel format
+ */
+static void draw_battery(const framebuffer *fb, const palette *colors);
+
+/**
+ * Record that the splash is visible.
+ */
+static void mark_shown(void);
+
+
+/**
+ * Static functions
+ */
+
+static uint32_t pack_color(const struct fb_var_screeninfo *vinfo, uint32_t rgb) {
+    uint32_t r = (rgb >> 16) & 0xFF;
+    uint32_t g = (rgb >> 8) & 0xFF;
+    uint32_t b = rgb & 0xFF;
+
+    uint32_t pixel = ((r >> (8 - vinfo->red.length)) << vinfo->red.offset)
+        | ((g >> (8 - vinfo->green.length)) << vinfo->green.offset)
+        | ((b >> (8 - vinfo->blue.length)) << vinfo->blue.offset);
+    if (vinfo->transp.length > 0) {
+        pixel |= ((1U << vinfo->transp.length) - 1) << vinfo->transp.offset;
+    }
+    return pixel;
+}
+
+static int isqrt(int value) {
+    int root = 0;
+    while ((root + 1) * (root + 1) <= value) {
+        ++root;
+    }
+    return root;
+}
+
+static int get_corner_inset(int row, int height, int radius) {
+    int distance;
+    if (row < radius) {
+        distance = radius - row;
+    } else if (row >= height - radius) {
+        distance = row - (height - radius) + 1;
+    } else {
+        return 0;
+    }
+
+    /* Sample at the pixel center, in half pixel units to stay in integers */
+    int dy = 2 * distance - 1;
+    return radius - isqrt(4 * radius * radius - dy * dy) / 2;
+}
+
+static void fill_span(const framebuffer *fb, const clip_area *clip, int y, int x0, int x1, uint32_t color) {
+    if (y < clip->y0 || y >= clip->y1) {
+        return;
+    }
+    if (x0 < clip->x0) {
+        x0 = clip->x0;
+    }
+    if (x1 > clip->x1) {
+        x1 = clip->x1;
+    }
+
+    uint8_t *line = fb->pixels + (size_t)y * fb->line_length;
+    if (fb->bytes_per_pixel == 4) {
+        uint32_t *pixel = (uint32_t *)line;
+        for (int x = x0; x < x1; ++x) {
+            pixel[x] = color;
+        }
+    } else {
+        uint16_t *pixel = (uint16_t *)line;
+        for (int x = x0; x < x1; ++x) {
+            pixel[x] = (uint16_t)color;
+        }
+    }
+}
+
+static void draw_rounded_rect(const framebuffer *fb, const clip_area *clip, int x, int y, int w, int h, int radius,
+    int border, uint32_t color) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+
+    int max_radius = (w < h ? w : h) / 2;
+    if (radius > max_radius) {
+        radius = max_radius;
+    }
+    if (2 * border >= w || 2 * border >= h) {
+        border = 0;
+    }
+    int inner_radius = radius > border ? radius - border : 0;
+
+    for (int row = 0; row < h; ++row) {
+        int outer = get_corner_inset(row, h, radius);
+
+        if (border == 0 || row < border || row >= h - border) {
+            fill_span(fb, clip, y + row, x + outer, x + w - outer, color);
+            continue;
+        }
+
+        int inner = border + get_corner_inset(row - border, h - 2 * border, inner_radius);
+        fill_span(fb, clip, y + row, x + outer, x + inner, color);
+        fill_span(fb, clip, y + row, x + w - inner, x + w - outer, color);
+    }
+}
+
+static void draw_battery(const framebuffer *fb, const palette *colors) {
+    clip_area screen = { 0, 0, fb->width, fb->height };
+
+    for (int y = 0; y < fb->height; ++y) {
+        fill_span(fb, &screen, y, 0, fb->width, colors->background);
+    }
+
+    int battery_x = (fb->width - BATTERY_WIDTH) / 2;
+    int battery_y = (fb->height - BATTERY_HEIGHT) / 2;
+    draw_rounded_rect(fb, &screen, battery_x, battery_y, BATTERY_WIDTH, BATTERY_HEIGHT, BATTERY_RADIUS,
+        BATTERY_BORDER, colors->border);
+
+    /* LVGL places the fill inside the border and clips it to the battery */
+    int capacity = splash_capacity < 99 ? splash_capacity : 99;
+    int content_width = BATTERY_WIDTH - 2 * BATTERY_BORDER;
+    int fill_width = content_width * splash_fill_width_pct / 100;
+    int fill_height = capacity * FILL_HEIGHT_PER_PCT;
+    clip_area battery = { battery_x, battery_y, battery_x + BATTERY_WIDTH, battery_y + BATTERY_HEIGHT };
+    draw_rounded_rect(fb, &battery, battery_x + BATTERY_BORDER + (content_width - fill_width) / 2,
+        battery_y + BATTERY_HEIGHT - BATTERY_BORDER - fill_height, fill_width, fill_height, FILL_RADIUS, 0,
+        colors->fill);
+
+    draw_rounded_rect(fb, &screen, (fb->width - TIP_WIDTH) / 2, TIP_Y, TIP_WIDTH, TIP_HEIGHT, TIP_RADIUS,
+        TIP_BORDER, colors->border);
+}
+
+static void mark_shown(void) {
+    shown_time_us = trace_now_us();
+    trace_mark("splash");
+}
+
+
+/**
+ * Public functions
+ */
+
+void splash_set_level(int capacity, int fill_width_pct, uint32_t fill_color) {
+    splash_capacity = capacity;
+    splash_fill_width_pct = fill_width_pct;
+    splash_fill_color = fill_color;
+}
+
+bool splash_show(void) {
+#if USE_FBDEV
+    if (splash_capacity < 0 || splash_capacity > 100) {
+        return false;
+    }
+
+    int fd = open(FBDEV_PATH, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct fb_var_screeninfo vinfo;
+    struct fb_fix_screeninfo finfo;
+    if (ioctl(fd, FBIOGET_VSCREENINFO, &vinfo) != 0 || ioctl(fd, FBIOGET_FSCREENINFO, &finfo) != 0) {
+        close(fd);
+        return false;
+    }
+
+    if ((vinfo.bits_per_pixel != 32 && vinfo.bits_per_pixel != 16) || vinfo.red.length > 8
+        || vinfo.green.length > 8 || vinfo.blue.length > 8) {
+        printf("Skipping splash for unsupported pixel format (%u bpp)\n", vinfo.bits_per_pixel);
+        close(fd);
+        return false;
+    }
+
+    uint8_t *map = mmap(NULL, finfo.smem_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    framebuffer fb;
+    fb.bytes_per_pixel = vinfo.bits_per_pixel / 8;
+    fb.pixels = map + (size_t)vinfo.yoffset * finfo.line_length + (size_t)vinfo.xoffset * fb.bytes_per_pixel;
+    fb.width = vinfo.xres;
+    fb.height = vinfo.yres;
+    fb.line_length = finfo.line_length;
+
+    if ((size_t)(fb.pixels - map) + (size_t)fb.height * fb.line_length > finfo.smem_len) {
+        munmap(map, finfo.smem_len);
+        close(fd);
+        return false;
+    }
+
+    palette colors = { pack_color(&vinfo, COLOR_BACKGROUND), pack_color(&vinfo, COLOR_BORDER),
+        pack_color(&vinfo, splash_fill_color) };
+    draw_battery(&fb, &colors);
+
+    /* Some drivers only push the buffer to the panel on a pan */
+    ioctl(fd, FBIOPAN_DISPLAY, &vinfo);
+
+    munmap(map, finfo.smem_len);
+    close(fd);
+
+    mark_shown();
+    return true;
+#else
+    return false;
+#endif /* USE_FBDEV */
+}
+
+bool splash_flush(uint32_t hor_res, uint32_t ver_res, startup_flush_cb_t flush_cb) {
+    if (splash_capacity < 0 || splash_capacity > 100 || hor_res == 0 || ver_res == 0 || flush_cb == NULL) {
+        return false;
+    }
+
+    lv_color_t *pixels = malloc((size_t)hor_res * ver_res * sizeof(lv_color_t));
+    if (pixels == NULL) {
+        printf("Failed to allocate splash frame\n");
+        return false;
+    }
+
+    framebuffer fb = { (uint8_t *)pixels, (int)hor_res, (int)ver_res, (int)(hor_res * sizeof(lv_color_t)),
+        (int)sizeof(lv_color_t) };
+    palette colors = { lv_color_hex(COLOR_BACKGROUND).full, lv_color_hex(COLOR_BORDER).full,
+        lv_color_hex(splash_fill_color).full };
+    draw_battery(&fb, &colors);
+
+    /* The backend only needs to know that this is the whole frame, LVGL's display isn't registered yet */
+    static lv_disp_draw_buf_t draw_buf;
+    static lv_disp_drv_t disp_drv;
+    lv_disp_draw_buf_init(&draw_buf, pixels, NULL, hor_res * ver_res);
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = (lv_coord_t)hor_res;
+    disp_drv.ver_res = (lv_coord_t)ver_res;
+    disp_drv.draw_buf = &draw_buf;
+    draw_buf.flushing = 1;
+    draw_buf.flushing_last = 1;
+
+    lv_area_t area = { 0, 0, (lv_coord_t)hor_res - 1, (lv_coord_t)ver_res - 1 };
+    flush_cb(&disp_drv, &area, pixels);
+    free(pixels);
+
+    mark_shown();
+    return true;
+}
+
+int64_t splash_get_shown_time_us(void) {
+    return shown_time_us;
+}
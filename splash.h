@@ -0,0 +1,66 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SPLASH_H
+#define SPLASH_H
+
+#include "startup.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Set the battery level shown by the splash. Must be called before splash_show or splash_flush.
+ *
+ * @param capacity battery capacity in percent (0 - 100)
+ * @param fill_width_pct width of the battery fill in percent of the battery's content width
+ * @param fill_color color of the battery fill in 0xRRGGBB format
+ */
+void splash_set_level(int capacity, int fill_width_pct, uint32_t fill_color);
+
+/**
+ * Draw a simplified battery straight into the framebuffer without going through LVGL. The
+ * geometry matches the UI built in charger_ui.c so that the first LVGL frame takes over
+ * seamlessly. Only supported for fbdev with 16 or 32 bits per pixel.
+ *
+ * @return true if the splash was drawn, false otherwise
+ */
+bool splash_show(void);
+
+/**
+ * Draw the same battery into a frame in LVGL's color format and push it through a backend's flush
+ * callback, for backends such as DRM and minui whose buffers aren't reachable otherwise. Must be
+ * called after the backend has been initialised and before the LVGL display is registered.
+ *
+ * @param hor_res horizontal resolution of the display
+ * @param ver_res vertical resolution of the display
+ * @param flush_cb the backend's flush callback
+ * @return true if the splash was flushed, false otherwise
+ */
+bool splash_flush(uint32_t hor_res, uint32_t ver_res, startup_flush_cb_t flush_cb);
+
+/**
+ * Get the time at which the splash was drawn.
+ *
+ * @return microseconds since boot (CLOCK_BOOTTIME) or -1 if no splash was drawn
+ */
+int64_t splash_get_shown_time_us(void);
+
+#endif /* SPLASH_H */
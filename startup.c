@@ -0,0 +1,286 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "startup.h"
+
+#include "shutdown.h"
+#include "splash.h"
+#include "terminal.h"
+#include "trace.h"
+
+#include "lv_drv_conf.h"
+
+#if USE_FBDEV
+#include "lv_drivers/display/fbdev.h"
+#endif /* USE_FBDEV */
+#if USE_DRM
+#include "lv_drivers/display/drm.h"
+#endif /* USE_DRM */
+#if USE_MINUI
+#include "lv_drivers/display/minui.h"
+#endif /* USE_MINUI */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <linux/fb.h>
+
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+
+/**
+ * Static variables
+ */
+
+#define PLYMOUTH_PATH "/usr/bin/plymouth"
+
+static pid_t plymouth_pid = -1;
+static int plymouth_trace = -1;
+
+static pthread_t backend_thread;
+static bool is_backend_thread_running = false;
+static backends_backend_id_t backend_id = BACKENDS_BACKEND_NONE;
+static startup_display backend_display;
+static bool is_backend_ok = false;
+static bool is_terminal_prepared = false;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Wait for the plymouth process spawned by startup_quit_plymouth to exit.
+ */
+static void wait_plymouth(void);
+
+/**
+ * Initialise the display backend. Runs on the backend thread.
+ *
+ * @param arg is unused
+ * @return NULL
+ */
+static void *init_backend(void *arg);
+
+#if USE_FBDEV
+/**
+ * Flush callback of a display registered with probed parameters. Waits for the backend and hands
+ * over to its flush callback, so that a refresh before the backend is up doesn't lose the area.
+ *
+ * @param disp_drv display driver
+ * @param area area to flush
+ * @param color_p pixels to flush
+ */
+static void flush_before_backend(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+#endif /* USE_FBDEV */
+
+
+/**
+ * Static functions
+ */
+
+static void wait_plymouth(void) {
+    if (plymouth_pid < 0) {
+        return;
+    }
+
+    int status;
+    while (waitpid(plymouth_pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            perror("Failed to wait for plymouth");
+            break;
+        }
+    }
+
+    plymouth_pid = -1;
+    trace_end(plymouth_trace);
+}
+
+static void *init_backend(void *arg) {
+    LV_UNUSED(arg);
+
+    /* Plymouth holds the display until it has exited */
+    wait_plymouth();
+
+    int phase = trace_begin("backend");
+    switch (backend_id) {
+#if USE_FBDEV
+    case BACKENDS_BACKEND_FBDEV:
+        /* Show the battery before LVGL has rendered anything, the first flush paints over it */
+        splash_show();
+        fbdev_init();
+        fbdev_get_sizes(&(backend_display.hor_res), &(backend_display.ver_res), &(backend_display.dpi));
+        backend_display.flush_cb = fbdev_flush;
+        is_backend_ok = true;
+        break;
+#endif /* USE_FBDEV */
+#if USE_DRM
+    case BACKENDS_BACKEND_DRM:
+        drm_init();
+        drm_get_sizes((lv_coord_t *)&(backend_display.hor_res), (lv_coord_t *)&(backend_display.ver_res), &(backend_display.dpi));
+        backend_display.flush_cb = drm_flush;
+        is_backend_ok = true;
+        splash_flush(backend_display.hor_res, backend_display.ver_res, drm_flush);
+        break;
+#endif /* USE_DRM */
+#if USE_MINUI
+    case BACKENDS_BACKEND_MINUI:
+        minui_init();
+        minui_get_sizes(&(backend_display.hor_res), &(backend_display.ver_res), &(backend_display.dpi));
+        backend_display.flush_cb = minui_flush;
+        is_backend_ok = true;
+        splash_flush(backend_display.hor_res, backend_display.ver_res, minui_flush);
+        break;
+#endif /* USE_MINUI */
+    default:
+        break;
+    }
+    trace_end(phase);
+
+    return NULL;
+}
+
+#if USE_FBDEV
+static void flush_before_backend(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
+    startup_display display;
+    startup_wait_backend(&display);
+
+    disp_drv->flush_cb = display.flush_cb;
+    display.flush_cb(disp_drv, area, color_p);
+}
+#endif /* USE_FBDEV */
+
+
+/**
+ * Public functions
+ */
+
+void startup_quit_plymouth(void) {
+    if (access(PLYMOUTH_PATH, X_OK) != 0) {
+        return;
+    }
+
+    char *argv[] = { "plymouth", "quit", NULL };
+
+    plymouth_trace = trace_begin("plymouth");
+    int ret = posix_spawn(&plymouth_pid, PLYMOUTH_PATH, NULL, NULL, argv, environ);
+    if (ret != 0) {
+        printf("Failed to spawn plymouth: %s\n", strerror(ret));
+        plymouth_pid = -1;
+        trace_end(plymouth_trace);
+    }
+}
+
+void startup_init_backend_async(backends_backend_id_t backend) {
+    backend_id = backend;
+
+    if (pthread_create(&backend_thread, NULL, init_backend, NULL) != 0) {
+        printf("Failed to create backend thread, initialising synchronously\n");
+        init_backend(NULL);
+        return;
+    }
+
+    is_backend_thread_running = true;
+}
+
+bool startup_probe_display(backends_backend_id_t backend, startup_display *display) {
+#if USE_FBDEV
+    if (backend != BACKENDS_BACKEND_FBDEV) {
+        return false;
+    }
+
+    int fd = open(FBDEV_PATH, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct fb_var_screeninfo vinfo;
+    int ret = ioctl(fd, FBIOGET_VSCREENINFO, &vinfo);
+    close(fd);
+    if (ret != 0) {
+        return false;
+    }
+
+    /* Same computation as fbdev_get_sizes, the result is verified once the backend is up */
+    display->hor_res = vinfo.xres;
+    display->ver_res = vinfo.yres;
+    display->dpi = vinfo.width > 0 ? (vinfo.xres * 254 + vinfo.width * 10 - 1) / (vinfo.width * 10) : LV_DPI_DEF;
+    display->flush_cb = flush_before_backend;
+    return true;
+#else
+    LV_UNUSED(backend);
+    LV_UNUSED(display);
+    return false;
+#endif /* USE_FBDEV */
+}
+
+void startup_wait_backend(startup_display *display) {
+    if (is_backend_thread_running) {
+        pthread_join(backend_thread, NULL);
+        is_backend_thread_running = false;
+    }
+
+    if (!is_backend_ok) {
+        shutdown_exit(EXIT_FAILURE, "Unable to find suitable backend");
+    }
+
+    /* The kernel signals VT switches to the thread that set the VT mode and can't once it has exited,
+     * so this must not happen on the backend thread. Plymouth has restored the terminal by now. */
+    if (!is_terminal_prepared) {
+        int phase = trace_begin("terminal");
+        terminal_prepare_current_terminal();
+        trace_end(phase);
+        is_terminal_prepared = true;
+    }
+
+    *display = backend_display;
+}
+
+void startup_release_backend(void) {
+    if (!is_backend_ok) {
+        return;
+    }
+    is_backend_ok = false;
+
+    switch (backend_id) {
+#if USE_FBDEV
+    case BACKENDS_BACKEND_FBDEV:
+        fbdev_exit();
+        break;
+#endif /* USE_FBDEV */
+#if USE_DRM
+    case BACKENDS_BACKEND_DRM:
+        drm_exit();
+        break;
+#endif /* USE_DRM */
+    default:
+        /* minui keeps its device open until the process exits */
+        break;
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include "backends.h"
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Display driver flush callback */
+typedef void (*startup_flush_cb_t)(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+
+/**
+ * Display parameters reported by a backend
+ */
+typedef struct {
+    uint32_t hor_res;
+    uint32_t ver_res;
+    uint32_t dpi;
+    startup_flush_cb_t flush_cb;
+} startup_display;
+
+/**
+ * Ask plymouth to quit without going through a shell. Returns immediately, the exit is awaited
+ * before the display backend is initialised.
+ */
+void startup_quit_plymouth(void);
+
+/**
+ * Initialise the display backend on a separate thread. The thread waits for plymouth to quit,
+ * then draws the splash and initialises the backend. fbdev shows the splash before its backend is
+ * initialised, DRM and minui flush it through their backend right after.
+ *
+ * @param backend backend to initialise
+ */
+void startup_init_backend_async(backends_backend_id_t backend);
+
+/**
+ * Try to determine the display geometry before the backend has been initialised, so that the
+ * UI can be built concurrently. Only possible for fbdev. The reported flush callback waits for the
+ * backend and then forwards to the backend's, so that the display can be registered right away.
+ *
+ * @param backend backend that is being initialised
+ * @param display pointer for writing the display parameters into
+ * @return true if the geometry could be determined, false otherwise
+ */
+bool startup_probe_display(backends_backend_id_t backend, startup_display *display);
+
+/**
+ * Wait for the display backend initialisation to finish and exit on failure. Prepares the current
+ * terminal on the first call, which must happen on the main thread.
+ *
+ * @param display pointer for writing the display parameters into
+ */
+void startup_wait_backend(startup_display *display);
+
+/**
+ * Release the framebuffer or DRM device of the initialised backend.
+ */
+void startup_release_backend(void);
+
+#endif /* STARTUP_H */
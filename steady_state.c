@@ -0,0 +1,220 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "steady_state.h"
+
+#include "allocator.h"
+#include "shutdown.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/**
+ * Static variables
+ */
+
+static bool is_enabled = false;
+static bool is_strict_mode = false;
+
+static lv_disp_t *instrumented_disp = NULL;
+static void (*original_flush_cb)(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) = NULL;
+static lv_timer_cb_t original_refr_timer_cb = NULL;
+
+static steady_state_counters current;
+static steady_state_counters last;
+static bool has_changed = false;
+
+/* Bounding boxes of the areas marked as changed in the current and the previous tick. The previous
+ * tick's box is kept because a change may only be flushed on the next LVGL refresh. */
+static lv_area_t changed_areas[2];
+static bool has_changed_areas[2] = { false, false };
+static uint32_t num_ticks = 0;
+static uint32_t num_violations = 0;
+
+static allocator_stats last_allocator_stats;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Count a flush and forward it to the display driver.
+ *
+ * @param disp_drv display driver
+ * @param area area to flush
+ * @param color_p pixels to flush
+ */
+static void counting_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+
+/**
+ * Count the invalidated areas and forward to LVGL's refresh timer.
+ *
+ * @param timer refresh timer
+ */
+static void counting_refr_timer_cb(lv_timer_t *timer);
+
+/**
+ * Check whether an area lies within the areas marked as changed.
+ *
+ * @param area area in display coordinates
+ * @return true if the change is expected, false otherwise
+ */
+static bool is_expected_area(const lv_area_t *area);
+
+/**
+ * Count the allocations since the previous call.
+ *
+ * @return number of allocations
+ */
+static uint32_t count_allocations(void);
+
+
+/**
+ * Static functions
+ */
+
+static void counting_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
+    /* LVGL adds the driver's offset before flushing */
+    lv_area_t disp_area = *area;
+    lv_area_move(&disp_area, -disp_drv->offset_x, -disp_drv->offset_y);
+
+    if (!is_expected_area(&disp_area)) {
+        current.flushes++;
+        current.flushed_pixels += lv_area_get_size(area);
+    }
+    original_flush_cb(disp_drv, area, color_p);
+}
+
+static void counting_refr_timer_cb(lv_timer_t *timer) {
+    for (uint16_t i = 0; i < instrumented_disp->inv_p; ++i) {
+        if (!is_expected_area(&(instrumented_disp->inv_areas[i]))) {
+            current.invalidated_areas++;
+        }
+    }
+    original_refr_timer_cb(timer);
+}
+
+static bool is_expected_area(const lv_area_t *area) {
+    for (int i = 0; i < 2; ++i) {
+        if (has_changed_areas[i] && _lv_area_is_in(area, &(changed_areas[i]), 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t count_allocations(void) {
+    allocator_stats stats;
+    allocator_get_stats(&stats);
+
+    uint32_t allocations = 0;
+    for (int i = 0; i < ALLOCATOR_NUM_PHASES; ++i) {
+        allocations += stats.allocations[i] - last_allocator_stats.allocations[i];
+        allocations += stats.heap_allocations[i] - last_allocator_stats.heap_allocations[i];
+    }
+
+    /* Without linker wrapping the built-in allocator doesn't count calls, detect net changes at least */
+    if (allocations == 0 && (stats.live_bytes != last_allocator_stats.live_bytes
+            || stats.live_allocations != last_allocator_stats.live_allocations)) {
+        allocations = 1;
+    }
+
+    last_allocator_stats = stats;
+    return allocations;
+}
+
+
+/**
+ * Public functions
+ */
+
+void steady_state_init(lv_disp_t *disp, bool is_strict) {
+    instrumented_disp = disp;
+    is_strict_mode = is_strict;
+
+    original_flush_cb = disp->driver->flush_cb;
+    disp->driver->flush_cb = counting_flush_cb;
+
+    lv_timer_t *refr_timer = _lv_disp_get_refr_timer(disp);
+    original_refr_timer_cb = refr_timer->timer_cb;
+    refr_timer->timer_cb = counting_refr_timer_cb;
+
+    allocator_get_stats(&last_allocator_stats);
+    is_enabled = true;
+
+    printf("Steady state instrumentation enabled%s\n", is_strict ? " (strict)" : "");
+}
+
+void steady_state_mark_change(void) {
+    has_changed = true;
+}
+
+void steady_state_mark_area_change(const lv_area_t *area) {
+    if (has_changed_areas[0]) {
+        _lv_area_join(&(changed_areas[0]), &(changed_areas[0]), area);
+    } else {
+        changed_areas[0] = *area;
+        has_changed_areas[0] = true;
+    }
+}
+
+bool steady_state_end_tick(void) {
+    if (!is_enabled) {
+        return true;
+    }
+
+    current.allocations = count_allocations();
+    last = current;
+    num_ticks++;
+
+    bool is_ok = has_changed || (last.allocations == 0 && last.invalidated_areas == 0 && last.flushes == 0);
+
+    current = (steady_state_counters){ 0 };
+    has_changed = false;
+    changed_areas[1] = changed_areas[0];
+    has_changed_areas[1] = has_changed_areas[0];
+    has_changed_areas[0] = false;
+
+    if (is_ok) {
+        return true;
+    }
+
+    num_violations++;
+    printf("Steady state violated in tick %u: %u allocations, %u invalidated areas, %u flushes (%u pixels) without changes\n",
+        num_ticks, last.allocations, last.invalidated_areas, last.flushes, last.flushed_pixels);
+
+    if (is_strict_mode) {
+        shutdown_exit(EXIT_FAILURE, "Steady state violated");
+    }
+
+    return false;
+}
+
+void steady_state_log_stats(void) {
+    if (!is_enabled) {
+        printf("Steady state instrumentation disabled\n");
+        return;
+    }
+
+    printf("Steady state: last tick had %u allocations, %u invalidated areas, %u flushes (%u pixels), %u of %u ticks violated\n",
+        last.allocations, last.invalidated_areas, last.flushes, last.flushed_pixels, num_violations, num_ticks);
+}
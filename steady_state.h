@@ -0,0 +1,81 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef STEADY_STATE_H
+#define STEADY_STATE_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Counters for a single tick
+ */
+typedef struct {
+    /* lv_mem and heap allocation calls made by the program. Allocations inside of libc or shared
+     * libraries aren't seen. Without linker wrapping, only net lv_mem changes of the built-in
+     * allocator and calls into a custom allocator are. */
+    uint32_t allocations;
+    /* Areas invalidated before a refresh */
+    uint32_t invalidated_areas;
+    /* Calls to the display driver's flush callback */
+    uint32_t flushes;
+    /* Pixels passed to the display driver's flush callback */
+    uint32_t flushed_pixels;
+} steady_state_counters;
+
+/**
+ * Start instrumenting a display. Wraps the display's flush callback and refresh timer to count
+ * flushes and invalidated areas.
+ *
+ * @param disp display to instrument
+ * @param is_strict if true, exit with failure when a tick without changes allocates or flushes
+ */
+void steady_state_init(lv_disp_t *disp, bool is_strict);
+
+/**
+ * Record that the current tick changed the UI.
+ */
+void steady_state_mark_change(void);
+
+/**
+ * Record that the current tick redraws an area on purpose, e.g. for an animation. Unlike
+ * steady_state_mark_change, the tick is still checked: invalidations and flushes within the area
+ * are expected until the end of the next tick, anything outside of it and any allocation is not.
+ *
+ * @param area changed area in display coordinates
+ */
+void steady_state_mark_area_change(const lv_area_t *area);
+
+/**
+ * End the current tick, check it against the steady state guarantee and start the next one.
+ * A tick without changes must not allocate, invalidate or flush anything.
+ *
+ * @return true if the tick satisfied the guarantee, false otherwise
+ */
+bool steady_state_end_tick(void);
+
+/**
+ * Print the counters of the most recently completed tick and the number of violations so far.
+ */
+void steady_state_log_stats(void);
+
+#endif /* STEADY_STATE_H */
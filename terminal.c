@@ -26,6 +26,7 @@
 #include <stdio.h>
 
 #include <linux/kd.h>
+#include <linux/vt.h>
 
 #include <sys/ioctl.h>
 
@@ -39,6 +40,10 @@ static int current_fd = -1;
 static int original_mode = KD_TEXT;
 static int original_kb_mode = K_UNICODE;
 
+static bool is_switch_controlled = false;
+static bool is_released = false;
+static terminal_switch_cb_t switch_cb = NULL;
+
 
 /**
  * Static prototypes
@@ -113,6 +118,53 @@ void terminal_prepare_current_terminal(void) {
     if (ioctl(current_fd, KDSETMODE, KD_GRAPHICS) != 0) {
         printf("Could not set terminal mode to graphics\n");
     }
+
+    /* Let the kernel ask before switching away so that rendering can be paused */
+    struct vt_mode mode = { .mode = VT_PROCESS, .relsig = TERMINAL_SWITCH_SIGNAL, .acqsig = TERMINAL_SWITCH_SIGNAL };
+    if (ioctl(current_fd, VT_SETMODE, &mode) != 0) {
+        printf("Could not take over terminal switching\n");
+    } else {
+        is_switch_controlled = true;
+    }
+}
+
+void terminal_set_switch_cb(terminal_switch_cb_t cb) {
+    switch_cb = cb;
+}
+
+bool terminal_is_switch_controlled(void) {
+    return is_switch_controlled;
+}
+
+void terminal_handle_switch_signal(int signo) {
+    (void)signo;
+
+    if (current_fd < 0 || !is_switch_controlled) {
+        return;
+    }
+
+    /* The same signal is used for both directions */
+    if (!is_released) {
+        if (switch_cb) {
+            switch_cb(false);
+        }
+        if (ioctl(current_fd, VT_RELDISP, 1) != 0) {
+            printf("Could not release terminal\n");
+            if (switch_cb) {
+                switch_cb(true);
+            }
+            return;
+        }
+        is_released = true;
+    } else {
+        if (ioctl(current_fd, VT_RELDISP, VT_ACKACQ) != 0) {
+            printf("Could not acknowledge terminal acquisition\n");
+        }
+        is_released = false;
+        if (switch_cb) {
+            switch_cb(true);
+        }
+    }
 }
 
 void terminal_reset_current_terminal(void) {
@@ -121,6 +173,14 @@ void terminal_reset_current_terminal(void) {
         return;
     }
 
+    if (is_switch_controlled) {
+        struct vt_mode mode = { .mode = VT_AUTO };
+        if (ioctl(current_fd, VT_SETMODE, &mode) != 0) {
+            printf("Could not reset terminal switching\n");
+        }
+        is_switch_controlled = false;
+    }
+
     // NB: The order of calls appears to matter for some devices. See
     // https://gitlab.com/cherrypicker/unl0kr/-/issues/34 for further info.
 
@@ -21,11 +21,42 @@
 #ifndef TERMINAL_H
 #define TERMINAL_H
 
+#include <signal.h>
+#include <stdbool.h>
+
+/* Signal the kernel sends when the VT is about to be released or has been reacquired */
+#define TERMINAL_SWITCH_SIGNAL SIGUSR2
+
+/* Callback for VT switches, is_active is false before the VT is released and true after it was reacquired */
+typedef void (*terminal_switch_cb_t)(bool is_active);
+
 /**
- * Prepare the current TTY for graphics output.
+ * Prepare the current TTY for graphics output and take over VT switching. TERMINAL_SWITCH_SIGNAL
+ * must be routed to terminal_handle_switch_signal.
  */
 void terminal_prepare_current_terminal(void);
 
+/**
+ * Set the callback to invoke on VT switches.
+ *
+ * @param cb callback to invoke
+ */
+void terminal_set_switch_cb(terminal_switch_cb_t cb);
+
+/**
+ * Check whether VT switches are reported through the switch callback.
+ *
+ * @return true if the VT is in process controlled switching mode, false otherwise
+ */
+bool terminal_is_switch_controlled(void);
+
+/**
+ * Acknowledge a VT release or acquisition.
+ *
+ * @param signo the signal's number
+ */
+void terminal_handle_switch_signal(int signo);
+
 /**
  * Reset the current TTY to text output.
  */
@@ -0,0 +1,213 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "allocator.h"
+#include "charger_ui.h"
+#include "config.h"
+#include "event_loop.h"
+#include "steady_state.h"
+#include "theme.h"
+#include "themes.h"
+
+#include "lvgl/lvgl.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/**
+ * Static variables
+ */
+
+#define HOR_RES 720
+#define VER_RES 1440
+#define NUM_TICKS 100
+#define TICK_PERIOD_MS 33
+#define CAPACITY 42
+
+static uint32_t fake_tick_ms = 0;
+static uint32_t num_flushes = 0;
+
+static lv_color_t framebuffer[HOR_RES * VER_RES];
+static lv_color_t draw_buffer[HOR_RES * VER_RES / 10];
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Copy flushed pixels into the RAM framebuffer and count the flush.
+ *
+ * @param disp_drv display driver
+ * @param area area to flush
+ * @param color_p pixels to flush
+ */
+static void headless_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+
+/**
+ * Register a display that renders into the RAM framebuffer.
+ *
+ * @return the registered display
+ */
+static lv_disp_t *headless_disp_register(void);
+
+/**
+ * Count all allocation calls made so far.
+ *
+ * @return number of LVGL and heap allocations
+ */
+static uint32_t count_allocations(void);
+
+/**
+ * Run ticks the way the charger does: a battery sample, LVGL's timers and the event loop.
+ *
+ * @param status battery status to sample
+ * @return number of ticks that violated the steady state guarantee
+ */
+static uint32_t run_ticks(const char *status);
+
+
+/**
+ * Static functions
+ */
+
+static void headless_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
+    for (lv_coord_t y = area->y1; y <= area->y2; ++y) {
+        for (lv_coord_t x = area->x1; x <= area->x2; ++x) {
+            framebuffer[y * HOR_RES + x] = *color_p++;
+        }
+    }
+    num_flushes++;
+    lv_disp_flush_ready(disp_drv);
+}
+
+static lv_disp_t *headless_disp_register(void) {
+    static lv_disp_draw_buf_t draw_buf;
+    lv_disp_draw_buf_init(&draw_buf, draw_buffer, NULL, sizeof(draw_buffer) / sizeof(draw_buffer[0]));
+
+    static lv_disp_drv_t disp_drv;
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = HOR_RES;
+    disp_drv.ver_res = VER_RES;
+    disp_drv.draw_buf = &draw_buf;
+    disp_drv.flush_cb = headless_flush_cb;
+    return lv_disp_drv_register(&disp_drv);
+}
+
+static uint32_t count_allocations(void) {
+    allocator_stats stats;
+    allocator_get_stats(&stats);
+
+    uint32_t allocations = 0;
+    for (int i = 0; i < ALLOCATOR_NUM_PHASES; ++i) {
+        allocations += stats.allocations[i] + stats.heap_allocations[i];
+    }
+    return allocations;
+}
+
+static uint32_t run_ticks(const char *status) {
+    uint32_t num_violations = 0;
+    for (int i = 0; i < NUM_TICKS; ++i) {
+        fake_tick_ms += TICK_PERIOD_MS;
+        charger_ui_update(CAPACITY, status);
+        lv_timer_handler();
+        event_loop_run_once(0);
+        if (!steady_state_end_tick()) {
+            num_violations++;
+        }
+    }
+    return num_violations;
+}
+
+
+/**
+ * Public functions
+ */
+
+int main(void) {
+#if !USE_ALLOCATOR_WRAP && !LV_MEM_CUSTOM
+    /* Without counted calls a same-size free and alloc would pass unnoticed */
+    printf("Allocation calls aren't counted in this build, skipping\n");
+    return 77;
+#endif
+
+    /* Build the charger's UI with every optional part enabled, like main does */
+    event_loop_init();
+    theme_prepare(&(themes_themes[THEMES_THEME_BREEZY_DARK]), &(themes_themes[THEMES_THEME_BREEZY_LIGHT]));
+    lv_init();
+    lv_disp_t *disp = headless_disp_register();
+    lv_obj_set_style_bg_color(lv_scr_act(), lv_color_black(), LV_PART_MAIN);
+    theme_switch(false);
+
+    config_opts_general opts = { 0 };
+    opts.animations = true;
+    opts.animation_fps = 30;
+    opts.history_chart = true;
+    opts.clock_format = "%H:%M";
+    charger_ui_init(lv_scr_act(), &opts);
+    charger_ui_update(CAPACITY, "Discharging");
+
+    /* Render the first frame and end the startup allocation phase */
+    lv_refr_now(disp);
+    allocator_end_startup();
+    steady_state_init(disp, false);
+
+    /* Idle: nothing may be flushed or allocated at all */
+    uint32_t flushes_before = num_flushes;
+    uint32_t allocations_before = count_allocations();
+    uint32_t idle_violations = run_ticks("Discharging");
+    uint32_t idle_flushes = num_flushes - flushes_before;
+    uint32_t idle_allocations = count_allocations() - allocations_before;
+    printf("Idle: %d ticks, %u flushes, %u allocations, %u violations\n", NUM_TICKS, idle_flushes, idle_allocations,
+        idle_violations);
+
+    /* Charging: only the band may be redrawn and still nothing may be allocated */
+    flushes_before = num_flushes;
+    allocations_before = count_allocations();
+    uint32_t charging_violations = run_ticks("Charging");
+    uint32_t charging_flushes = num_flushes - flushes_before;
+    uint32_t charging_allocations = count_allocations() - allocations_before;
+    printf("Charging: %d ticks, %u flushes, %u allocations, %u violations\n", NUM_TICKS, charging_flushes,
+        charging_allocations, charging_violations);
+
+    steady_state_log_stats();
+
+    /* The animation must have run for the charging ticks to mean anything */
+    if (idle_flushes != 0 || idle_allocations != 0 || idle_violations != 0 || charging_flushes == 0
+            || charging_allocations != 0 || charging_violations != 0) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Tick generation
+ */
+
+/**
+ * Generate tick for LVGL. Advanced manually so the test doesn't depend on wall clock time.
+ *
+ * @return tick in ms
+ */
+uint32_t get_tick(void) {
+    return fake_tick_ms;
+}
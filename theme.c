@@ -20,24 +20,26 @@
 
 #include "theme.h"
 
+#include "allocator.h"
 #include "lvglcharger.h"
 
 #include "lvgl/lvgl.h"
 
+#include <stddef.h>
 #include <stdio.h>
+#include <time.h>
 
 /**
  * Static variables
  */
 
-static theme current_theme;
-static lv_theme_t lv_theme;
-
-static struct {
+/* Styles derived from a single theme. Must only contain lv_style_t members, indexes are used to map between sets. */
+typedef struct {
     lv_style_t widget;
     lv_style_t window;
     lv_style_t header;
-    lv_style_t key;
+    lv_style_t label;
+#if !USE_MINIMAL_THEME
     lv_style_t button;
     lv_style_t button_pressed;
     lv_style_t textarea;
@@ -47,16 +49,53 @@ static struct {
     lv_style_t dropdown_pressed;
     lv_style_t dropdown_list;
     lv_style_t dropdown_list_selected;
-    lv_style_t label;
     lv_style_t msgbox;
     lv_style_t msgbox_label;
     lv_style_t msgbox_btnmatrix;
     lv_style_t msgbox_background;
     lv_style_t bar;
     lv_style_t bar_indicator;
-} styles; 
+#endif /* !USE_MINIMAL_THEME */
+} theme_styles;
+
+#define THEME_NUM_STYLES (sizeof(theme_styles) / sizeof(lv_style_t))
+#define THEME_STYLE_INDEX(member) (offsetof(theme_styles, member) / sizeof(lv_style_t))
+
+/* Groups of styles that are materialised together on first use by a matching object */
+typedef enum {
+    THEME_GROUP_BASE,
+#if !USE_MINIMAL_THEME
+    THEME_GROUP_BUTTON,
+    THEME_GROUP_TEXTAREA,
+    THEME_GROUP_DROPDOWN,
+    THEME_GROUP_MSGBOX,
+    THEME_GROUP_BAR,
+#endif /* !USE_MINIMAL_THEME */
+    THEME_NUM_GROUPS
+} theme_group_id_t;
+
+/* Style group descriptor */
+typedef struct {
+    const char *name;
+    size_t first_style;
+    size_t num_styles;
+    void (*init)(theme_styles *styles, const theme *theme, bool is_initialised);
+} theme_group;
+
+static lv_theme_t lv_theme;
+static bool is_lv_theme_registered = false;
+
+/* Index 0 holds the default theme's styles, index 1 the alternate theme's styles */
+static const theme *prepared_themes[2] = { NULL, NULL };
+static theme_styles style_sets[2];
+static bool is_group_materialised[THEME_NUM_GROUPS];
+static int active_set = 0;
+
+/* Whether the style at a given index resolves to different properties in the two sets */
+static bool does_style_differ[THEME_NUM_STYLES];
 
-static bool are_styles_initialised = false;
+/* Battery fill color per capacity for both prepared themes */
+static lv_color_t fill_colors[2][101];
 
 
 /**
@@ -64,18 +103,116 @@ static bool are_styles_initialised = false;
  */
 
 /**
- * Set up the static styles for a specific theme.
+ * Set up the base styles (widget, window, header and label) for a specific theme.
  *
+ * @param styles style set to initialise
  * @param theme theme to derive the styles from
+ * @param is_initialised true if the styles have been initialised before
  */
-static void init_styles(const theme *theme);
+static void init_base_styles(theme_styles *styles, const theme *theme, bool is_initialised);
+
+#if !USE_MINIMAL_THEME
+/**
+ * Set up the button styles for a specific theme.
+ *
+ * @param styles style set to initialise
+ * @param theme theme to derive the styles from
+ * @param is_initialised true if the styles have been initialised before
+ */
+static void init_button_styles(theme_styles *styles, const theme *theme, bool is_initialised);
+
+/**
+ * Set up the text area styles for a specific theme.
+ *
+ * @param styles style set to initialise
+ * @param theme theme to derive the styles from
+ * @param is_initialised true if the styles have been initialised before
+ */
+static void init_textarea_styles(theme_styles *styles, const theme *theme, bool is_initialised);
+
+/**
+ * Set up the dropdown styles for a specific theme.
+ *
+ * @param styles style set to initialise
+ * @param theme theme to derive the styles from
+ * @param is_initialised true if the styles have been initialised before
+ */
+static void init_dropdown_styles(theme_styles *styles, const theme *theme, bool is_initialised);
+
+/**
+ * Set up the message box styles for a specific theme.
+ *
+ * @param styles style set to initialise
+ * @param theme theme to derive the styles from
+ * @param is_initialised true if the styles have been initialised before
+ */
+static void init_msgbox_styles(theme_styles *styles, const theme *theme, bool is_initialised);
+
+/**
+ * Set up the progress bar styles for a specific theme.
+ *
+ * @param styles style set to initialise
+ * @param theme theme to derive the styles from
+ * @param is_initialised true if the styles have been initialised before
+ */
+static void init_bar_styles(theme_styles *styles, const theme *theme, bool is_initialised);
+#endif /* !USE_MINIMAL_THEME */
+
+/**
+ * Materialise a style group in both style sets unless it has been materialised already.
+ *
+ * @param group_id ID of the group to materialise
+ * @param force if true, rebuild the group even if it has been materialised before
+ */
+static void materialise_group(theme_group_id_t group_id, bool force);
 
 /**
  * Initialise or reset a style.
  *
  * @param style style to reset
+ * @param is_initialised true if the style has been initialised before
+ */
+static void reset_style(lv_style_t *style, bool is_initialised);
+
+/**
+ * Interpolate between two colors.
+ *
+ * @param from color at position 0 in 0xRRGGBB format
+ * @param to color at position range in 0xRRGGBB format
+ * @param pos position between the colors
+ * @param range distance between the colors
+ * @return interpolated color
+ */
+static lv_color_t mix_colors(uint32_t from, uint32_t to, int pos, int range);
+
+/**
+ * Precompute the battery fill color for every capacity.
+ *
+ * @param colors table of 101 colors to fill
+ * @param battery battery theme to derive the colors from
+ */
+static void build_fill_colors(lv_color_t *colors, const theme_battery *battery);
+
+/**
+ * Check whether two styles resolve to different values for any built-in property.
+ *
+ * @param a first style
+ * @param b second style
+ * @return true if the styles differ, false otherwise
+ */
+static bool styles_differ(const lv_style_t *a, const lv_style_t *b);
+
+/**
+ * Point all styles of an object and its children from one style set to another and refresh
+ * only those objects whose styles actually differ between the sets.
+ *
+ * @param obj object to process
+ * @param from style set to replace
+ * @param to style set to use instead
+ * @param num_objects pointer to a counter of visited objects
+ * @param num_refreshed pointer to a counter of refreshed objects
  */
-static void reset_style(lv_style_t *style);
+static void swap_styles(lv_obj_t *obj, theme_styles *from, theme_styles *to, uint32_t *num_objects, uint32_t *num_refreshed);
 
 /**
  * Apply a theme to an object.
@@ -86,154 +223,290 @@ static void reset_style(lv_style_t *style);
 static void apply_theme_cb(lv_theme_t *theme, lv_obj_t *obj);
 
 
+/* Style groups, indexed by theme_group_id_t */
+static const theme_group groups[] = {
+    { "base", THEME_STYLE_INDEX(widget), 4, init_base_styles },
+#if !USE_MINIMAL_THEME
+    { "button", THEME_STYLE_INDEX(button), 2, init_button_styles },
+    { "textarea", THEME_STYLE_INDEX(textarea), 3, init_textarea_styles },
+    { "dropdown", THEME_STYLE_INDEX(dropdown), 4, init_dropdown_styles },
+    { "msgbox", THEME_STYLE_INDEX(msgbox), 4, init_msgbox_styles },
+    { "bar", THEME_STYLE_INDEX(bar), 2, init_bar_styles },
+#endif /* !USE_MINIMAL_THEME */
+};
+
+
 /**
  * Static functions
  */
 
-static void init_styles(const theme *theme) {
-    reset_style(&(styles.widget));
-
-    reset_style(&(styles.window));
-    lv_style_set_bg_opa(&(styles.window), LV_OPA_COVER);
-    lv_style_set_bg_color(&(styles.window), lv_color_hex(theme->window.bg_color));
-
-    reset_style(&(styles.header));
-    lv_style_set_bg_opa(&(styles.header), LV_OPA_COVER);
-    lv_style_set_bg_color(&(styles.header), lv_color_hex(theme->header.bg_color));
-    lv_style_set_border_side(&(styles.header), LV_BORDER_SIDE_BOTTOM);
-    lv_style_set_border_width(&(styles.header), lv_dpx(theme->header.border_width));
-    lv_style_set_border_color(&(styles.header), lv_color_hex(theme->header.border_color));
-    lv_style_set_pad_all(&(styles.header), lv_dpx(theme->header.pad));
-    lv_style_set_pad_gap(&(styles.header), lv_dpx(theme->header.gap));
-
-    reset_style(&(styles.button));
-    lv_style_set_text_color(&(styles.button), lv_color_hex(theme->button.normal.fg_color));
-    lv_style_set_bg_opa(&(styles.button), LV_OPA_COVER);
-    lv_style_set_bg_color(&(styles.button), lv_color_hex(theme->button.normal.bg_color));
-    lv_style_set_border_side(&(styles.button), LV_BORDER_SIDE_FULL);
-    lv_style_set_border_width(&(styles.button), lv_dpx(theme->button.border_width));
-    lv_style_set_border_color(&(styles.button), lv_color_hex(theme->button.normal.border_color));
-    lv_style_set_radius(&(styles.button), lv_dpx(theme->button.corner_radius));
-    lv_style_set_pad_all(&(styles.button), lv_dpx(theme->button.pad));
-
-    reset_style(&(styles.button_pressed));
-    lv_style_set_text_color(&(styles.button_pressed), lv_color_hex(theme->button.pressed.fg_color));
-    lv_style_set_bg_color(&(styles.button_pressed), lv_color_hex(theme->button.pressed.bg_color));
-    lv_style_set_border_color(&(styles.button_pressed), lv_color_hex(theme->button.pressed.border_color));
-
-    reset_style(&(styles.textarea));
-    lv_style_set_text_color(&(styles.textarea), lv_color_hex(theme->textarea.fg_color));
-    lv_style_set_bg_opa(&(styles.textarea), LV_OPA_COVER);
-    lv_style_set_bg_color(&(styles.textarea), lv_color_hex(theme->textarea.bg_color));  
-    lv_style_set_border_side(&(styles.textarea), LV_BORDER_SIDE_FULL);
-    lv_style_set_border_width(&(styles.textarea), lv_dpx(theme->textarea.border_width));
-    lv_style_set_border_color(&(styles.textarea), lv_color_hex(theme->textarea.border_color));
-    lv_style_set_radius(&(styles.textarea), lv_dpx(theme->textarea.corner_radius));
-    lv_style_set_pad_all(&(styles.textarea), lv_dpx(theme->textarea.pad));
-
-    reset_style(&(styles.textarea_placeholder));
-    lv_style_set_text_color(&(styles.textarea_placeholder), lv_color_hex(theme->textarea.placeholder_color));
-
-    reset_style(&(styles.textarea_cursor));
-    lv_style_set_border_side(&(styles.textarea_cursor), LV_BORDER_SIDE_LEFT);
-    lv_style_set_border_width(&(styles.textarea_cursor), lv_dpx(theme->textarea.cursor.width));
-    lv_style_set_border_color(&(styles.textarea_cursor), lv_color_hex(theme->textarea.cursor.color));
-    lv_style_set_anim_time(&(styles.textarea_cursor), theme->textarea.cursor.period);
-
-    reset_style(&(styles.dropdown));
-    lv_style_set_text_color(&(styles.dropdown), lv_color_hex(theme->dropdown.button.normal.fg_color));
-    lv_style_set_bg_opa(&(styles.dropdown), LV_OPA_COVER);
-    lv_style_set_bg_color(&(styles.dropdown), lv_color_hex(theme->dropdown.button.normal.bg_color));
-    lv_style_set_border_side(&(styles.dropdown), LV_BORDER_SIDE_FULL);
-    lv_style_set_border_width(&(styles.dropdown), lv_dpx(theme->dropdown.button.border_width));
-    lv_style_set_border_color(&(styles.dropdown), lv_color_hex(theme->dropdown.button.normal.border_color));
-    lv_style_set_radius(&(styles.dropdown), lv_dpx(theme->dropdown.button.corner_radius));
-    lv_style_set_pad_all(&(styles.dropdown), lv_dpx(theme->dropdown.button.pad));
-
-    reset_style(&(styles.dropdown_pressed));
-    lv_style_set_text_color(&(styles.dropdown_pressed), lv_color_hex(theme->dropdown.button.pressed.fg_color));
-    lv_style_set_bg_color(&(styles.dropdown_pressed), lv_color_hex(theme->dropdown.button.pressed.bg_color));
-    lv_style_set_border_color(&(styles.dropdown_pressed), lv_color_hex(theme->dropdown.button.pressed.border_color));
-
-    reset_style(&(styles.dropdown_list));
-    lv_style_set_text_color(&(styles.dropdown_list), lv_color_hex(theme->dropdown.list.fg_color));
-    lv_style_set_bg_opa(&(styles.dropdown_list), LV_OPA_COVER);
-    lv_style_set_bg_color(&(styles.dropdown_list), lv_color_hex(theme->dropdown.list.bg_color));
-    lv_style_set_border_side(&(styles.dropdown_list), LV_BORDER_SIDE_FULL);
-    lv_style_set_border_width(&(styles.dropdown_list), lv_dpx(theme->dropdown.list.border_width));
-    lv_style_set_border_color(&(styles.dropdown_list), lv_color_hex(theme->dropdown.list.border_color));
-    lv_style_set_radius(&(styles.dropdown_list), lv_dpx(theme->dropdown.list.corner_radius));
-    lv_style_set_pad_all(&(styles.dropdown_list), lv_dpx(theme->dropdown.list.pad));
-
-    reset_style(&(styles.dropdown_list_selected));
-    lv_style_set_text_color(&(styles.dropdown_list_selected), lv_color_hex(theme->dropdown.list.selection_fg_color));
-    lv_style_set_bg_opa(&(styles.dropdown_list_selected), LV_OPA_COVER);
-    lv_style_set_bg_color(&(styles.dropdown_list_selected), lv_color_hex(theme->dropdown.list.selection_bg_color));
-
-    reset_style(&(styles.label));
-    lv_style_set_text_color(&(styles.label), lv_color_hex(theme->label.fg_color));
-
-    reset_style(&(styles.msgbox));
-    lv_style_set_text_color(&(styles.msgbox), lv_color_hex(theme->msgbox.fg_color));
-    lv_style_set_bg_opa(&(styles.msgbox), LV_OPA_COVER);
-    lv_style_set_bg_color(&(styles.msgbox), lv_color_hex(theme->msgbox.bg_color));
-    lv_style_set_border_side(&(styles.msgbox), LV_BORDER_SIDE_FULL);
-    lv_style_set_border_width(&(styles.msgbox), lv_dpx(theme->msgbox.border_width));
-    lv_style_set_border_color(&(styles.msgbox), lv_color_hex(theme->msgbox.border_color));
-    lv_style_set_radius(&(styles.msgbox), lv_dpx(theme->msgbox.corner_radius));
-    lv_style_set_pad_all(&(styles.msgbox), lv_dpx(theme->msgbox.pad));
-
-    reset_style(&(styles.msgbox_label));
-    lv_style_set_text_align(&(styles.msgbox_label), LV_TEXT_ALIGN_CENTER);
-    lv_style_set_pad_bottom(&(styles.msgbox_label), lv_dpx(theme->msgbox.gap));
-
-    reset_style(&(styles.msgbox_btnmatrix));
-    lv_style_set_pad_gap(&(styles.msgbox_btnmatrix), lv_dpx(theme->msgbox.buttons.gap));
-    lv_style_set_min_width(&(styles.msgbox_btnmatrix), LV_PCT(100));
-
-    reset_style(&(styles.msgbox_background));
-    lv_style_set_bg_color(&(styles.msgbox_background), lv_color_hex(theme->msgbox.dimming.color));
-    lv_style_set_bg_opa(&(styles.msgbox_background), theme->msgbox.dimming.opacity);
-
-    reset_style(&(styles.bar));
-    lv_style_set_border_side(&(styles.bar), LV_BORDER_SIDE_FULL);
-    lv_style_set_border_width(&(styles.bar), lv_dpx(theme->bar.border_width));
-    lv_style_set_border_color(&(styles.bar), lv_color_hex(theme->bar.border_color));
-    lv_style_set_radius(&(styles.bar), lv_dpx(theme->bar.corner_radius));
-
-    reset_style(&(styles.bar_indicator));
-    lv_style_set_bg_opa(&(styles.bar_indicator), LV_OPA_COVER);
-    lv_style_set_bg_color(&(styles.bar_indicator), lv_color_hex(theme->bar.indicator.bg_color));
-
-    are_styles_initialised = true;
+static void init_base_styles(theme_styles *styles, const theme *theme, bool is_initialised) {
+    reset_style(&(styles->widget), is_initialised);
+
+    reset_style(&(styles->window), is_initialised);
+    lv_style_set_bg_opa(&(styles->window), LV_OPA_COVER);
+    lv_style_set_bg_color(&(styles->window), lv_color_hex(theme->window.bg_color));
+
+    reset_style(&(styles->header), is_initialised);
+    lv_style_set_bg_opa(&(styles->header), LV_OPA_COVER);
+    lv_style_set_bg_color(&(styles->header), lv_color_hex(theme->header.bg_color));
+    lv_style_set_border_side(&(styles->header), LV_BORDER_SIDE_BOTTOM);
+    lv_style_set_border_width(&(styles->header), lv_dpx(theme->header.border_width));
+    lv_style_set_border_color(&(styles->header), lv_color_hex(theme->header.border_color));
+    lv_style_set_pad_all(&(styles->header), lv_dpx(theme->header.pad));
+    lv_style_set_pad_gap(&(styles->header), lv_dpx(theme->header.gap));
+
+    reset_style(&(styles->label), is_initialised);
+    lv_style_set_text_color(&(styles->label), lv_color_hex(theme->label.fg_color));
 }
 
-static void reset_style(lv_style_t *style) {
-    if (are_styles_initialised) {
+#if !USE_MINIMAL_THEME
+static void init_button_styles(theme_styles *styles, const theme *theme, bool is_initialised) {
+    reset_style(&(styles->button), is_initialised);
+    lv_style_set_text_color(&(styles->button), lv_color_hex(theme->button.normal.fg_color));
+    lv_style_set_bg_opa(&(styles->button), LV_OPA_COVER);
+    lv_style_set_bg_color(&(styles->button), lv_color_hex(theme->button.normal.bg_color));
+    lv_style_set_border_side(&(styles->button), LV_BORDER_SIDE_FULL);
+    lv_style_set_border_width(&(styles->button), lv_dpx(theme->button.border_width));
+    lv_style_set_border_color(&(styles->button), lv_color_hex(theme->button.normal.border_color));
+    lv_style_set_radius(&(styles->button), lv_dpx(theme->button.corner_radius));
+    lv_style_set_pad_all(&(styles->button), lv_dpx(theme->button.pad));
+
+    reset_style(&(styles->button_pressed), is_initialised);
+    lv_style_set_text_color(&(styles->button_pressed), lv_color_hex(theme->button.pressed.fg_color));
+    lv_style_set_bg_color(&(styles->button_pressed), lv_color_hex(theme->button.pressed.bg_color));
+    lv_style_set_border_color(&(styles->button_pressed), lv_color_hex(theme->button.pressed.border_color));
+}
+
+static void init_textarea_styles(theme_styles *styles, const theme *theme, bool is_initialised) {
+    reset_style(&(styles->textarea), is_initialised);
+    lv_style_set_text_color(&(styles->textarea), lv_color_hex(theme->textarea.fg_color));
+    lv_style_set_bg_opa(&(styles->textarea), LV_OPA_COVER);
+    lv_style_set_bg_color(&(styles->textarea), lv_color_hex(theme->textarea.bg_color));  
+    lv_style_set_border_side(&(styles->textarea), LV_BORDER_SIDE_FULL);
+    lv_style_set_border_width(&(styles->textarea), lv_dpx(theme->textarea.border_width));
+    lv_style_set_border_color(&(styles->textarea), lv_color_hex(theme->textarea.border_color));
+    lv_style_set_radius(&(styles->textarea), lv_dpx(theme->textarea.corner_radius));
+    lv_style_set_pad_all(&(styles->textarea), lv_dpx(theme->textarea.pad));
+
+    reset_style(&(styles->textarea_placeholder), is_initialised);
+    lv_style_set_text_color(&(styles->textarea_placeholder), lv_color_hex(theme->textarea.placeholder_color));
+
+    reset_style(&(styles->textarea_cursor), is_initialised);
+    lv_style_set_border_side(&(styles->textarea_cursor), LV_BORDER_SIDE_LEFT);
+    lv_style_set_border_width(&(styles->textarea_cursor), lv_dpx(theme->textarea.cursor.width));
+    lv_style_set_border_color(&(styles->textarea_cursor), lv_color_hex(theme->textarea.cursor.color));
+    lv_style_set_anim_time(&(styles->textarea_cursor), theme->textarea.cursor.period);
+}
+
+static void init_dropdown_styles(theme_styles *styles, const theme *theme, bool is_initialised) {
+    reset_style(&(styles->dropdown), is_initialised);
+    lv_style_set_text_color(&(styles->dropdown), lv_color_hex(theme->dropdown.button.normal.fg_color));
+    lv_style_set_bg_opa(&(styles->dropdown), LV_OPA_COVER);
+    lv_style_set_bg_color(&(styles->dropdown), lv_color_hex(theme->dropdown.button.normal.bg_color));
+    lv_style_set_border_side(&(styles->dropdown), LV_BORDER_SIDE_FULL);
+    lv_style_set_border_width(&(styles->dropdown), lv_dpx(theme->dropdown.button.border_width));
+    lv_style_set_border_color(&(styles->dropdown), lv_color_hex(theme->dropdown.button.normal.border_color));
+    lv_style_set_radius(&(styles->dropdown), lv_dpx(theme->dropdown.button.corner_radius));
+    lv_style_set_pad_all(&(styles->dropdown), lv_dpx(theme->dropdown.button.pad));
+
+    reset_style(&(styles->dropdown_pressed), is_initialised);
+    lv_style_set_text_color(&(styles->dropdown_pressed), lv_color_hex(theme->dropdown.button.pressed.fg_color));
+    lv_style_set_bg_color(&(styles->dropdown_pressed), lv_color_hex(theme->dropdown.button.pressed.bg_color));
+    lv_style_set_border_color(&(styles->dropdown_pressed), lv_color_hex(theme->dropdown.button.pressed.border_color));
+
+    reset_style(&(styles->dropdown_list), is_initialised);
+    lv_style_set_text_color(&(styles->dropdown_list), lv_color_hex(theme->dropdown.list.fg_color));
+    lv_style_set_bg_opa(&(styles->dropdown_list), LV_OPA_COVER);
+    lv_style_set_bg_color(&(styles->dropdown_list), lv_color_hex(theme->dropdown.list.bg_color));
+    lv_style_set_border_side(&(styles->dropdown_list), LV_BORDER_SIDE_FULL);
+    lv_style_set_border_width(&(styles->dropdown_list), lv_dpx(theme->dropdown.list.border_width));
+    lv_style_set_border_color(&(styles->dropdown_list), lv_color_hex(theme->dropdown.list.border_color));
+    lv_style_set_radius(&(styles->dropdown_list), lv_dpx(theme->dropdown.list.corner_radius));
+    lv_style_set_pad_all(&(styles->dropdown_list), lv_dpx(theme->dropdown.list.pad));
+
+    reset_style(&(styles->dropdown_list_selected), is_initialised);
+    lv_style_set_text_color(&(styles->dropdown_list_selected), lv_color_hex(theme->dropdown.list.selection_fg_color));
+    lv_style_set_bg_opa(&(styles->dropdown_list_selected), LV_OPA_COVER);
+    lv_style_set_bg_color(&(styles->dropdown_list_selected), lv_color_hex(theme->dropdown.list.selection_bg_color));
+}
+
+static void init_msgbox_styles(theme_styles *styles, const theme *theme, bool is_initialised) {
+    reset_style(&(styles->msgbox), is_initialised);
+    lv_style_set_text_color(&(styles->msgbox), lv_color_hex(theme->msgbox.fg_color));
+    lv_style_set_bg_opa(&(styles->msgbox), LV_OPA_COVER);
+    lv_style_set_bg_color(&(styles->msgbox), lv_color_hex(theme->msgbox.bg_color));
+    lv_style_set_border_side(&(styles->msgbox), LV_BORDER_SIDE_FULL);
+    lv_style_set_border_width(&(styles->msgbox), lv_dpx(theme->msgbox.border_width));
+    lv_style_set_border_color(&(styles->msgbox), lv_color_hex(theme->msgbox.border_color));
+    lv_style_set_radius(&(styles->msgbox), lv_dpx(theme->msgbox.corner_radius));
+    lv_style_set_pad_all(&(styles->msgbox), lv_dpx(theme->msgbox.pad));
+
+    reset_style(&(styles->msgbox_label), is_initialised);
+    lv_style_set_text_align(&(styles->msgbox_label), LV_TEXT_ALIGN_CENTER);
+    lv_style_set_pad_bottom(&(styles->msgbox_label), lv_dpx(theme->msgbox.gap));
+
+    reset_style(&(styles->msgbox_btnmatrix), is_initialised);
+    lv_style_set_pad_gap(&(styles->msgbox_btnmatrix), lv_dpx(theme->msgbox.buttons.gap));
+    lv_style_set_min_width(&(styles->msgbox_btnmatrix), LV_PCT(100));
+
+    reset_style(&(styles->msgbox_background), is_initialised);
+    lv_style_set_bg_color(&(styles->msgbox_background), lv_color_hex(theme->msgbox.dimming.color));
+    lv_style_set_bg_opa(&(styles->msgbox_background), theme->msgbox.dimming.opacity);
+}
+
+static void init_bar_styles(theme_styles *styles, const theme *theme, bool is_initialised) {
+    reset_style(&(styles->bar), is_initialised);
+    lv_style_set_border_side(&(styles->bar), LV_BORDER_SIDE_FULL);
+    lv_style_set_border_width(&(styles->bar), lv_dpx(theme->bar.border_width));
+    lv_style_set_border_color(&(styles->bar), lv_color_hex(theme->bar.border_color));
+    lv_style_set_radius(&(styles->bar), lv_dpx(theme->bar.corner_radius));
+
+    reset_style(&(styles->bar_indicator), is_initialised);
+    lv_style_set_bg_opa(&(styles->bar_indicator), LV_OPA_COVER);
+    lv_style_set_bg_color(&(styles->bar_indicator), lv_color_hex(theme->bar.indicator.bg_color));
+}
+#endif /* !USE_MINIMAL_THEME */
+
+static void reset_style(lv_style_t *style, bool is_initialised) {
+    if (is_initialised) {
         lv_style_reset(style);
     } else {
         lv_style_init(style);
     }
 }
 
+static lv_color_t mix_colors(uint32_t from, uint32_t to, int pos, int range) {
+    uint8_t channels[3];
+    for (int i = 0; i < 3; ++i) {
+        int shift = 16 - i * 8;
+        int a = (from >> shift) & 0xFF;
+        int b = (to >> shift) & 0xFF;
+        channels[i] = (uint8_t)(a + (b - a) * pos / range);
+    }
+    return lv_color_make(channels[0], channels[1], channels[2]);
+}
+
+static void build_fill_colors(lv_color_t *colors, const theme_battery *battery) {
+    for (int capacity = 0; capacity <= 100; ++capacity) {
+        if (capacity <= THEME_BATTERY_LOW_PCT) {
+            colors[capacity] = lv_color_hex(battery->low_color);
+        } else if (capacity <= THEME_BATTERY_MID_PCT) {
+            colors[capacity] = mix_colors(battery->low_color, battery->mid_color, capacity - THEME_BATTERY_LOW_PCT,
+                THEME_BATTERY_MID_PCT - THEME_BATTERY_LOW_PCT);
+        } else if (capacity <= THEME_BATTERY_HIGH_PCT) {
+            colors[capacity] = mix_colors(battery->mid_color, battery->high_color, capacity - THEME_BATTERY_MID_PCT,
+                THEME_BATTERY_HIGH_PCT - THEME_BATTERY_MID_PCT);
+        } else {
+            colors[capacity] = lv_color_hex(battery->high_color);
+        }
+    }
+}
+
+static bool styles_differ(const lv_style_t *a, const lv_style_t *b) {
+    for (lv_style_prop_t prop = 1; prop < _LV_STYLE_LAST_BUILT_IN_PROP; ++prop) {
+        lv_style_value_t value_a, value_b;
+        lv_res_t res_a = lv_style_get_prop(a, prop, &value_a);
+        lv_res_t res_b = lv_style_get_prop(b, prop, &value_b);
+
+        if (res_a != res_b) {
+            return true;
+        }
+
+        if (res_a == LV_RES_OK && (value_a.num != value_b.num || value_a.ptr != value_b.ptr || value_a.color.full != value_b.color.full)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void swap_styles(lv_obj_t *obj, theme_styles *from, theme_styles *to, uint32_t *num_objects, uint32_t *num_refreshed) {
+    lv_style_t *from_styles = (lv_style_t *)from;
+    lv_style_t *to_styles = (lv_style_t *)to;
+    bool needs_refresh = false;
+
+    for (uint32_t i = 0; i < obj->style_cnt; ++i) {
+        lv_style_t *style = obj->styles[i].style;
+        if (style < from_styles || style >= from_styles + THEME_NUM_STYLES) {
+            continue; /* Local or foreign style, leave untouched */
+        }
+
+        size_t index = style - from_styles;
+        obj->styles[i].style = &(to_styles[index]);
+        needs_refresh = needs_refresh || does_style_differ[index];
+    }
+
+    ++(*num_objects);
+    if (needs_refresh) {
+        lv_obj_refresh_style(obj, LV_PART_ANY, LV_STYLE_PROP_ANY);
+        ++(*num_refreshed);
+    }
+
+    uint32_t child_cnt = lv_obj_get_child_cnt(obj);
+    for (uint32_t i = 0; i < child_cnt; ++i) {
+        swap_styles(lv_obj_get_child(obj, i), from, to, num_objects, num_refreshed);
+    }
+}
+
+static void materialise_group(theme_group_id_t group_id, bool force) {
+    bool is_initialised = is_group_materialised[group_id];
+    if (is_initialised && !force) {
+        return;
+    }
+
+    const theme_group *group = &(groups[group_id]);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    allocator_stats mem_before;
+    allocator_get_stats(&mem_before);
+
+    group->init(&(style_sets[0]), prepared_themes[0], is_initialised);
+    group->init(&(style_sets[1]), prepared_themes[1], is_initialised);
+
+    lv_style_t *default_styles = (lv_style_t *)&(style_sets[0]);
+    lv_style_t *alternate_styles = (lv_style_t *)&(style_sets[1]);
+    for (size_t i = group->first_style; i < group->first_style + group->num_styles; ++i) {
+        does_style_differ[i] = styles_differ(&(default_styles[i]), &(alternate_styles[i]));
+    }
+
+    is_group_materialised[group_id] = true;
+
+    allocator_stats mem_after;
+    allocator_get_stats(&mem_after);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long elapsed_us = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_nsec - start.tv_nsec) / 1000L;
+    long used_bytes = (long)(mem_after.live_bytes) - (long)(mem_before.live_bytes);
+
+    printf("Materialised %s theme styles in %ld us (%ld bytes of lv_mem, %zu bytes static)\n",
+        group->name, elapsed_us, used_bytes, 2 * group->num_styles * sizeof(lv_style_t));
+}
+
 static void apply_theme_cb(lv_theme_t *theme, lv_obj_t *obj) {
     LV_UNUSED(theme);
 
-    lv_obj_add_style(obj, &(styles.widget), 0);
+    theme_styles *styles = &(style_sets[active_set]);
+
+    materialise_group(THEME_GROUP_BASE, false);
+    lv_obj_add_style(obj, &(styles->widget), 0);
 
     if (lv_obj_get_parent(obj) == NULL) {
-        lv_obj_add_style(obj, &(styles.window), 0);
+        lv_obj_add_style(obj, &(styles->window), 0);
         return;
     }
 
     if (lv_obj_has_flag(obj, WIDGET_HEADER)) {
-        lv_obj_add_style(obj, &(styles.header), 0);
+        lv_obj_add_style(obj, &(styles->header), 0);
         return;
     }
 
+#if !USE_MINIMAL_THEME
     if (lv_obj_check_type(obj, &lv_btn_class)) {
-        lv_obj_add_style(obj, &(styles.button), 0);
-        lv_obj_add_style(obj, &(styles.button_pressed), LV_STATE_PRESSED);
+        materialise_group(THEME_GROUP_BUTTON, false);
+        lv_obj_add_style(obj, &(styles->button), 0);
+        lv_obj_add_style(obj, &(styles->button_pressed), LV_STATE_PRESSED);
         return;
     }
 
@@ -242,9 +515,10 @@ static void apply_theme_cb(lv_theme_t *theme, lv_obj_t *obj) {
     }
 
     if (lv_obj_check_type(obj, &lv_textarea_class)) {
-        lv_obj_add_style(obj, &(styles.textarea), 0);
-        lv_obj_add_style(obj, &(styles.textarea_placeholder), LV_PART_TEXTAREA_PLACEHOLDER);
-        lv_obj_add_style(obj, &(styles.textarea_cursor), LV_PART_CURSOR | LV_STATE_FOCUSED);
+        materialise_group(THEME_GROUP_TEXTAREA, false);
+        lv_obj_add_style(obj, &(styles->textarea), 0);
+        lv_obj_add_style(obj, &(styles->textarea_placeholder), LV_PART_TEXTAREA_PLACEHOLDER);
+        lv_obj_add_style(obj, &(styles->textarea_cursor), LV_PART_CURSOR | LV_STATE_FOCUSED);
         return;
     }
 
@@ -253,15 +527,17 @@ static void apply_theme_cb(lv_theme_t *theme, lv_obj_t *obj) {
     }
 
     if (lv_obj_check_type(obj, &lv_dropdown_class)) {
-        lv_obj_add_style(obj, &(styles.dropdown), 0);
-        lv_obj_add_style(obj, &(styles.dropdown_pressed), LV_STATE_PRESSED);
+        materialise_group(THEME_GROUP_DROPDOWN, false);
+        lv_obj_add_style(obj, &(styles->dropdown), 0);
+        lv_obj_add_style(obj, &(styles->dropdown_pressed), LV_STATE_PRESSED);
         return;
     }
 
     if (lv_obj_check_type(obj, &lv_dropdownlist_class)) {
-        lv_obj_add_style(obj, &(styles.dropdown_list), 0);
-        lv_obj_add_style(obj, &(styles.dropdown_list_selected), LV_PART_SELECTED | LV_STATE_CHECKED);
-        lv_obj_add_style(obj, &(styles.dropdown_list_selected), LV_PART_SELECTED | LV_STATE_PRESSED);
+        materialise_group(THEME_GROUP_DROPDOWN, false);
+        lv_obj_add_style(obj, &(styles->dropdown_list), 0);
+        lv_obj_add_style(obj, &(styles->dropdown_list_selected), LV_PART_SELECTED | LV_STATE_CHECKED);
+        lv_obj_add_style(obj, &(styles->dropdown_list_selected), LV_PART_SELECTED | LV_STATE_PRESSED);
         return;
     }
 
@@ -270,37 +546,46 @@ static void apply_theme_cb(lv_theme_t *theme, lv_obj_t *obj) {
     }
 
     if (lv_obj_check_type(obj, &lv_msgbox_class)) {
-        lv_obj_add_style(obj, &(styles.msgbox), 0);
+        materialise_group(THEME_GROUP_MSGBOX, false);
+        lv_obj_add_style(obj, &(styles->msgbox), 0);
         return;
     }
 
     if (lv_obj_check_type(obj, &lv_label_class) && (lv_obj_check_type(lv_obj_get_parent(obj), &lv_msgbox_class) || lv_obj_check_type(lv_obj_get_parent(obj), &lv_msgbox_content_class))) {
-        lv_obj_add_style(obj, &(styles.msgbox_label), 0);
+        materialise_group(THEME_GROUP_MSGBOX, false);
+        lv_obj_add_style(obj, &(styles->msgbox_label), 0);
         return; /* Inherit styling from message box */
     }
 
     if (lv_obj_check_type(obj, &lv_btnmatrix_class) && lv_obj_check_type(lv_obj_get_parent(obj), &lv_msgbox_class)) {
-        lv_obj_add_style(obj, &(styles.msgbox_btnmatrix), 0);
-        lv_obj_add_style(obj, &(styles.button), LV_PART_ITEMS);
-        lv_obj_add_style(obj, &(styles.button_pressed), LV_PART_ITEMS | LV_STATE_PRESSED);
+        materialise_group(THEME_GROUP_MSGBOX, false);
+        materialise_group(THEME_GROUP_BUTTON, false);
+        lv_obj_add_style(obj, &(styles->msgbox_btnmatrix), 0);
+        lv_obj_add_style(obj, &(styles->button), LV_PART_ITEMS);
+        lv_obj_add_style(obj, &(styles->button_pressed), LV_PART_ITEMS | LV_STATE_PRESSED);
         return;
     }
 
     if (lv_obj_check_type(obj, &lv_msgbox_backdrop_class)) {
-        lv_obj_add_style(obj, &(styles.msgbox_background), 0);
+        materialise_group(THEME_GROUP_MSGBOX, false);
+        lv_obj_add_style(obj, &(styles->msgbox_background), 0);
         return;
     }
+#endif /* !USE_MINIMAL_THEME */
 
     if (lv_obj_check_type(obj, &lv_label_class) || lv_obj_check_type(obj, &lv_spangroup_class)) {
-        lv_obj_add_style(obj, &(styles.label), 0);
+        lv_obj_add_style(obj, &(styles->label), 0);
         return;
     }
 
+#if !USE_MINIMAL_THEME
     if (lv_obj_check_type(obj, &lv_bar_class)) {
-        lv_obj_add_style(obj, &(styles.bar), 0);
-        lv_obj_add_style(obj, &(styles.bar_indicator), LV_PART_INDICATOR);
+        materialise_group(THEME_GROUP_BAR, false);
+        lv_obj_add_style(obj, &(styles->bar), 0);
+        lv_obj_add_style(obj, &(styles->bar_indicator), LV_PART_INDICATOR);
         return;
     }
+#endif /* !USE_MINIMAL_THEME */
 }
 
 
@@ -308,19 +593,99 @@ static void apply_theme_cb(lv_theme_t *theme, lv_obj_t *obj) {
  * Public functions
  */
 
-void theme_apply(const theme *theme) {
-    if (!theme) {
-        printf("Could not apply theme from NULL pointer\n");
+void theme_prepare(const theme *default_theme, const theme *alternate_theme) {
+    if (!default_theme || !alternate_theme) {
+        printf("Could not prepare theme from NULL pointer\n");
+        return;
+    }
+
+    prepared_themes[0] = default_theme;
+    prepared_themes[1] = alternate_theme;
+    build_fill_colors(fill_colors[0], &(default_theme->battery));
+    build_fill_colors(fill_colors[1], &(alternate_theme->battery));
+
+    /* Groups are materialised lazily in apply_theme_cb, only rebuild those that are already in use */
+    bool is_rebuilt = false;
+    for (int i = 0; i < THEME_NUM_GROUPS; ++i) {
+        if (is_group_materialised[i]) {
+            materialise_group(i, true);
+            is_rebuilt = true;
+        }
+    }
+
+    if (is_rebuilt) {
+        lv_obj_report_style_change(NULL);
+    }
+}
+
+lv_color_t theme_get_fill_color(int capacity) {
+    return fill_colors[active_set][LV_CLAMP(0, capacity, 100)];
+}
+
+void theme_switch(bool is_alternate) {
+    if (!prepared_themes[0] || !prepared_themes[1]) {
+        printf("Could not switch theme before preparing it\n");
         return;
     }
 
-    lv_theme.disp = NULL;
-    lv_theme.apply_cb = apply_theme_cb;
+    int set = is_alternate ? 1 : 0;
+    if (is_lv_theme_registered && set == active_set) {
+        return;
+    }
 
-    current_theme = *theme;
-    init_styles(theme);
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    allocator_stats mem_before;
+    allocator_get_stats(&mem_before);
+
+    uint32_t num_objects = 0;
+    uint32_t num_refreshed = 0;
+
+    if (!is_lv_theme_registered) {
+        /* First application, style every object from scratch */
+        active_set = set;
+
+        lv_theme.disp = NULL;
+        lv_theme.apply_cb = apply_theme_cb;
+
+        lv_obj_report_style_change(NULL);
+        lv_disp_set_theme(NULL, &lv_theme);
+        for (lv_disp_t *disp = lv_disp_get_next(NULL); disp; disp = lv_disp_get_next(disp)) {
+            for (uint32_t i = 0; i < disp->screen_cnt; ++i) {
+                /* The layers are transparent screens, a window style would hide everything below */
+                lv_obj_t *screen = disp->screens[i];
+                if (screen != lv_disp_get_layer_top(disp) && screen != lv_disp_get_layer_sys(disp)) {
+                    lv_theme_apply(screen);
+                }
+            }
+        }
+        is_lv_theme_registered = true;
+    } else {
+        theme_styles *from = &(style_sets[active_set]);
+        theme_styles *to = &(style_sets[set]);
+        active_set = set;
+
+        /* Visit every screen including inactive ones, they'd otherwise keep pointing at the old set.
+         * The top and system layers are screens of their display as well. */
+        for (lv_disp_t *disp = lv_disp_get_next(NULL); disp; disp = lv_disp_get_next(disp)) {
+            for (uint32_t i = 0; i < disp->screen_cnt; ++i) {
+                swap_styles(disp->screens[i], from, to, &num_objects, &num_refreshed);
+            }
+        }
+    }
 
-    lv_obj_report_style_change(NULL);
-    lv_disp_set_theme(NULL, &lv_theme);
-    lv_theme_apply(lv_scr_act());
+    allocator_stats mem_after;
+    allocator_get_stats(&mem_after);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long elapsed_us = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_nsec - start.tv_nsec) / 1000L;
+
+    if (num_objects == 0) {
+        printf("Applied %s theme in %ld us", is_alternate ? "alternate" : "default", elapsed_us);
+    } else {
+        printf("Switched to %s theme in %ld us (%u of %u objects restyled)",
+            is_alternate ? "alternate" : "default", elapsed_us, num_refreshed, num_objects);
+    }
+    printf(", lv_mem %zu -> %zu bytes used in %u -> %u allocations\n", mem_before.live_bytes, mem_after.live_bytes,
+        mem_before.live_allocations, mem_after.live_allocations);
 }
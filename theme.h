@@ -28,6 +28,11 @@
 
 #define WIDGET_HEADER LV_OBJ_FLAG_USER_1
 
+/* Capacities (in percent) at which the battery fill reaches its low, mid and high color */
+#define THEME_BATTERY_LOW_PCT 15
+#define THEME_BATTERY_MID_PCT 40
+#define THEME_BATTERY_HIGH_PCT 75
+
 /**
  * Theming structs
  */
@@ -127,6 +132,13 @@ typedef struct {
     uint32_t fg_color;
 } theme_label;
 
+/* Battery theme, the fill fades from the low over the mid to the high color as the capacity rises */
+typedef struct {
+    uint32_t low_color;
+    uint32_t mid_color;
+    uint32_t high_color;
+} theme_battery;
+
 /* Message box buttons theme */
 typedef struct {
     lv_coord_t gap;
@@ -169,19 +181,42 @@ typedef struct {
     char *name;
     theme_window window;
     theme_header header;
+#if !USE_MINIMAL_THEME
     theme_button button;
     theme_textarea textarea;
     theme_dropdown dropdown;
+#endif /* !USE_MINIMAL_THEME */
     theme_label label;
+    theme_battery battery;
+#if !USE_MINIMAL_THEME
     theme_msgbox msgbox;
     theme_bar bar;
+#endif /* !USE_MINIMAL_THEME */
 } theme;
 
 /**
- * Apply a UI theme.
+ * Materialise the styles of a default and an alternate theme so that they can be switched without
+ * rebuilding any styles.
+ *
+ * @param default_theme the default theme
+ * @param alternate_theme the alternate theme
+ */
+void theme_prepare(const theme *default_theme, const theme *alternate_theme);
+
+/**
+ * Get the battery fill color of the active theme from the table built in theme_prepare.
+ *
+ * @param capacity battery capacity in percent, clamped to 0 - 100
+ * @return fill color
+ */
+lv_color_t theme_get_fill_color(int capacity);
+
+/**
+ * Switch the UI to one of the prepared themes. The first call styles all objects, subsequent calls
+ * swap style pointers and only refresh objects whose resolved styles differ between the themes.
  *
- * @param theme the theme to apply
+ * @param is_alternate true if the alternate theme should be applied, false if the default theme should be applied
  */
-void theme_apply(const theme *theme);
+void theme_switch(bool is_alternate);
 
 #endif /* THEME_H */
@@ -39,6 +39,7 @@ static const theme themes_breezy_light = {
         .pad = 10,
         .gap = 10
     },
+#if !USE_MINIMAL_THEME
     .button = {
         .border_width = 1,
         .corner_radius = 5,
@@ -95,9 +96,16 @@ static const theme themes_breezy_light = {
             .pad = 0
         }
     },
+#endif /* !USE_MINIMAL_THEME */
     .label = {
         .fg_color = 0x232629
     },
+    .battery = {
+        .low_color = 0xda4453,
+        .mid_color = 0xfdbc4b,
+        .high_color = 0x00ff00
+    },
+#if !USE_MINIMAL_THEME
     .msgbox = {
         .fg_color = 0x232629,
         .bg_color = 0xeff0f1,
@@ -122,6 +130,7 @@ static const theme themes_breezy_light = {
             .bg_color = 0x3daee9
         }
     }
+#endif /* !USE_MINIMAL_THEME */
 };
 
 
@@ -138,6 +147,7 @@ static const theme themes_breezy_dark = {
         .pad = 10,
         .gap = 10
     },
+#if !USE_MINIMAL_THEME
     .button = {
         .border_width = 1,
         .corner_radius = 5,
@@ -194,9 +204,16 @@ static const theme themes_breezy_dark = {
             .pad = 0
         }
     },
+#endif /* !USE_MINIMAL_THEME */
     .label = {
         .fg_color = 0xeff0f1
     },
+    .battery = {
+        .low_color = 0xda4453,
+        .mid_color = 0xfdbc4b,
+        .high_color = 0x00ff00
+    },
+#if !USE_MINIMAL_THEME
     .msgbox = {
         .fg_color = 0xeff0f1,
         .bg_color = 0x31363b,
@@ -221,6 +238,7 @@ static const theme themes_breezy_dark = {
             .bg_color = 0x3daee9
         }
     }
+#endif /* !USE_MINIMAL_THEME */
 };
 
 /* pmOS light (based on palette https://coolors.co/009900-395e66-db504a-e3b505-ebf5ee) */
@@ -236,6 +254,7 @@ static const theme themes_pmos_light = {
         .pad = 20,
         .gap = 10
     },
+#if !USE_MINIMAL_THEME
     .button = {
         .border_width = 1,
         .corner_radius = 3,
@@ -292,9 +311,16 @@ static const theme themes_pmos_light = {
             .pad = 8
         }
     },
+#endif /* !USE_MINIMAL_THEME */
     .label = {
         .fg_color = 0x070c0d
     },
+    .battery = {
+        .low_color = 0xe01b24,
+        .mid_color = 0xffa348,
+        .high_color = 0x00ff00
+    },
+#if !USE_MINIMAL_THEME
     .msgbox = {
         .fg_color = 0x070c0d,
         .bg_color = 0xd8e6e9,
@@ -319,6 +345,7 @@ static const theme themes_pmos_light = {
             .bg_color = 0x009900
         }
     }
+#endif /* !USE_MINIMAL_THEME */
 };
 
 /* pmOS dark (based on palette https://coolors.co/009900-395e66-db504a-e3b505-ebf5ee) */
@@ -334,6 +361,7 @@ static const theme themes_pmos_dark = {
         .pad = 20,
         .gap = 10
     },
+#if !USE_MINIMAL_THEME
     .button = {
         .border_width = 1,
         .corner_radius = 3,
@@ -390,9 +418,16 @@ static const theme themes_pmos_dark = {
             .pad = 8
         }
     },
+#endif /* !USE_MINIMAL_THEME */
     .label = {
         .fg_color = 0xf2f7f8,
     },
+    .battery = {
+        .low_color = 0xe01b24,
+        .mid_color = 0xffa348,
+        .high_color = 0x00ff00
+    },
+#if !USE_MINIMAL_THEME
     .msgbox = {
         .fg_color = 0xf2f7f8,
         .bg_color = 0x162427,
@@ -417,6 +452,7 @@ static const theme themes_pmos_dark = {
             .bg_color = 0x009900
         }
     }
+#endif /* !USE_MINIMAL_THEME */
 };
 
 /**
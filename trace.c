@@ -0,0 +1,230 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "trace.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/syscall.h>
+
+
+/**
+ * Static variables
+ */
+
+/* A recorded phase or instant event */
+typedef struct {
+    const char *name;
+    int64_t start_us;
+    /* -1 for instant events and phases that haven't ended */
+    int64_t end_us;
+    long tid;
+    bool is_instant;
+} trace_event;
+
+static trace_event events[TRACE_MAX_EVENTS];
+static atomic_int num_events = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Reserve a slot in the event buffer.
+ *
+ * @param name static name of the event
+ * @return index of the slot or -1 if the buffer is full
+ */
+static int add_event(const char *name);
+
+/**
+ * Get the number of recorded events.
+ *
+ * @return number of events in the buffer
+ */
+static int get_num_events(void);
+
+/**
+ * Determine when the process was started.
+ *
+ * @return microseconds since boot or -1 on failure
+ */
+static int64_t get_exec_time_us(void);
+
+/**
+ * Write the recorded events in the Chrome trace event format.
+ *
+ * @param path path of the file to write
+ * @param exec_us process start in microseconds since boot
+ */
+static void write_json(const char *path, int64_t exec_us);
+
+
+/**
+ * Static functions
+ */
+
+static int add_event(const char *name) {
+    int index = atomic_fetch_add(&num_events, 1);
+    if (index >= TRACE_MAX_EVENTS) {
+        return -1;
+    }
+
+    events[index].name = name;
+    events[index].start_us = trace_now_us();
+    events[index].end_us = -1;
+    events[index].tid = syscall(SYS_gettid);
+    events[index].is_instant = false;
+    return index;
+}
+
+static int get_num_events(void) {
+    int count = atomic_load(&num_events);
+    return count < TRACE_MAX_EVENTS ? count : TRACE_MAX_EVENTS;
+}
+
+static int64_t get_exec_time_us(void) {
+    FILE *file = fopen("/proc/self/stat", "r");
+    if (file == NULL) {
+        return -1;
+    }
+
+    char buffer[1024];
+    size_t len = fread(buffer, 1, sizeof(buffer) - 1, file);
+    fclose(file);
+    buffer[len] = '\0';
+
+    /* The command name may contain spaces, start parsing after its closing parenthesis */
+    char *p = strrchr(buffer, ')');
+    if (p == NULL) {
+        return -1;
+    }
+
+    /* starttime is field 22, the field after the command name is field 3 */
+    unsigned long long start_ticks;
+    if (sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu", &start_ticks) != 1) {
+        return -1;
+    }
+
+    return (int64_t)(start_ticks * 1000000ULL / sysconf(_SC_CLK_TCK));
+}
+
+static void write_json(const char *path, int64_t exec_us) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        printf("Could not open trace file %s\n", path);
+        return;
+    }
+
+    int count = get_num_events();
+    pid_t pid = getpid();
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    if (exec_us >= 0) {
+        fprintf(file, "{\"name\":\"exec\",\"ph\":\"i\",\"s\":\"p\",\"ts\":%lld,\"pid\":%d,\"tid\":%d}", (long long)exec_us, pid, pid);
+    } else {
+        fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"lvglcharger\"}}", pid);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const trace_event *event = &(events[i]);
+        if (event->is_instant) {
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"p\",\"ts\":%lld,\"pid\":%d,\"tid\":%ld}",
+                event->name, (long long)event->start_us, pid, event->tid);
+        } else if (event->end_us >= 0) {
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":%d,\"tid\":%ld}",
+                event->name, (long long)event->start_us, (long long)(event->end_us - event->start_us), pid, event->tid);
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    printf("Wrote startup trace to %s\n", path);
+}
+
+
+/**
+ * Public functions
+ */
+
+int64_t trace_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int trace_begin(const char *name) {
+    return add_event(name);
+}
+
+void trace_end(int handle) {
+    if (handle < 0 || handle >= TRACE_MAX_EVENTS) {
+        return;
+    }
+    events[handle].end_us = trace_now_us();
+}
+
+void trace_mark(const char *name) {
+    int index = add_event(name);
+    if (index >= 0) {
+        events[index].is_instant = true;
+    }
+}
+
+void trace_report(const char *json_path) {
+    int64_t exec_us = get_exec_time_us();
+    int count = get_num_events();
+
+    char summary[1024] = "";
+    size_t len = 0;
+
+    if (exec_us >= 0) {
+        len += snprintf(summary + len, sizeof(summary) - len, "exec@%lldms", (long long)(exec_us / 1000));
+    }
+
+    for (int i = 0; i < count && len < sizeof(summary); ++i) {
+        const trace_event *event = &(events[i]);
+        const char *separator = len > 0 ? " " : "";
+        if (event->is_instant && exec_us >= 0) {
+            len += snprintf(summary + len, sizeof(summary) - len, "%s%s@%lldms(+%lldms)", separator, event->name,
+                (long long)(event->start_us / 1000), (long long)((event->start_us - exec_us) / 1000));
+        } else if (event->is_instant) {
+            len += snprintf(summary + len, sizeof(summary) - len, "%s%s@%lldms", separator, event->name,
+                (long long)(event->start_us / 1000));
+        } else if (event->end_us >= 0) {
+            long long dur_us = event->end_us - event->start_us;
+            len += snprintf(summary + len, sizeof(summary) - len, "%s%s=%lld.%01lldms", separator, event->name,
+                dur_us / 1000, (dur_us % 1000) / 100);
+        }
+    }
+
+    printf("Startup (since boot): %s\n", summary);
+
+    if (json_path) {
+        write_json(json_path, exec_us);
+    }
+}
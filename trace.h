@@ -0,0 +1,66 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+/* Maximum number of events that can be recorded */
+#define TRACE_MAX_EVENTS 64
+
+/**
+ * Get the current time.
+ *
+ * @return microseconds since boot (CLOCK_BOOTTIME)
+ */
+int64_t trace_now_us(void);
+
+/**
+ * Start a startup phase. Safe to call from multiple threads.
+ *
+ * @param name static name of the phase
+ * @return handle to pass to trace_end or -1 if the event buffer is full
+ */
+int trace_begin(const char *name);
+
+/**
+ * End a startup phase.
+ *
+ * @param handle handle returned by trace_begin
+ */
+void trace_end(int handle);
+
+/**
+ * Record an instant event such as the first completed flush. Safe to call from multiple threads.
+ *
+ * @param name static name of the event
+ */
+void trace_mark(const char *name);
+
+/**
+ * Print a compact summary line of all recorded events and optionally write them to a file in the
+ * Chrome trace event format.
+ *
+ * @param json_path path of the trace file to write or NULL to skip it
+ */
+void trace_report(const char *json_path);
+
+#endif /* TRACE_H */
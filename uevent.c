@@ -0,0 +1,125 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "uevent.h"
+
+#include "event_loop.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <linux/netlink.h>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+
+/**
+ * Static variables
+ */
+
+/* Kernel uevents are limited to a few KiB of environment */
+#define UEVENT_BUFFER_SIZE 8192
+
+static int uevent_fd = -1;
+static const char *watched_subsystem = NULL;
+static uevent_cb_t uevent_cb = NULL;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Read and dispatch pending uevents.
+ *
+ * @param fd netlink socket
+ * @param events is unused
+ * @param user_data is unused
+ */
+static void handle_uevents(int fd, uint32_t events, void *user_data);
+
+
+/**
+ * Static functions
+ */
+
+static void handle_uevents(int fd, uint32_t events, void *user_data) {
+    (void)events;
+    (void)user_data;
+
+    char buffer[UEVENT_BUFFER_SIZE];
+    ssize_t len;
+    while ((len = recv(fd, buffer, sizeof(buffer) - 1, MSG_DONTWAIT)) > 0) {
+        buffer[len] = '\0';
+
+        /* The message is "action@devpath" followed by NUL separated KEY=VALUE pairs */
+        const char *action = NULL;
+        const char *devpath = NULL;
+        const char *subsystem = NULL;
+        for (char *p = buffer; p < buffer + len; p += strlen(p) + 1) {
+            if (strncmp(p, "ACTION=", 7) == 0) {
+                action = p + 7;
+            } else if (strncmp(p, "DEVPATH=", 8) == 0) {
+                devpath = p + 8;
+            } else if (strncmp(p, "SUBSYSTEM=", 10) == 0) {
+                subsystem = p + 10;
+            }
+        }
+
+        if (action && devpath && subsystem && strcmp(subsystem, watched_subsystem) == 0) {
+            uevent_cb(action, devpath);
+        }
+    }
+}
+
+
+/**
+ * Public functions
+ */
+
+bool uevent_init(const char *subsystem, uevent_cb_t cb) {
+    uevent_fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+    if (uevent_fd < 0) {
+        perror("Failed to open uevent socket");
+        return false;
+    }
+
+    /* Group 1 carries the kernel's own broadcasts and works without udev */
+    struct sockaddr_nl addr = { .nl_family = AF_NETLINK, .nl_pid = 0, .nl_groups = 1 };
+    if (bind(uevent_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("Failed to bind uevent socket");
+        close(uevent_fd);
+        uevent_fd = -1;
+        return false;
+    }
+
+    watched_subsystem = subsystem;
+    uevent_cb = cb;
+
+    if (!event_loop_add_fd(uevent_fd, EPOLLIN, handle_uevents, NULL)) {
+        close(uevent_fd);
+        uevent_fd = -1;
+        return false;
+    }
+
+    return true;
+}
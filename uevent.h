@@ -0,0 +1,39 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of lvglcharger, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UEVENT_H
+#define UEVENT_H
+
+#include <stdbool.h>
+
+/* Callback for a kernel uevent of the watched subsystem */
+typedef void (*uevent_cb_t)(const char *action, const char *devpath);
+
+/**
+ * Listen for kernel uevents of a subsystem on the event loop. Requires event_loop_init to have
+ * been called.
+ *
+ * @param subsystem subsystem to watch (e.g. "power_supply")
+ * @param cb callback to invoke for every matching uevent
+ * @return true on success, false otherwise
+ */
+bool uevent_init(const char *subsystem, uevent_cb_t cb);
+
+#endif /* UEVENT_H */